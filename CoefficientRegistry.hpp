@@ -0,0 +1,129 @@
+#ifndef _coefficient_registry_h
+#define _coefficient_registry_h
+
+#include <cstddef>
+#include <tuple>
+#include "TrigonometricCoeffs.hpp"
+
+namespace rodrigues_formula
+{
+
+     /**
+      * @brief Coefficient selectors. Each one names a coefficient and evaluates it on any
+      * TrigonometricCoeffs instance with a direct, inlinable call.
+      */
+     namespace coefficient
+     {
+#define RODRIGUES_COEFFICIENT_SELECTOR(Name, member)                    \
+          struct Name                                                   \
+          {                                                             \
+               static const char *name() { return #member; }            \
+               template < class TCs, typename T >                       \
+               static T eval(const TCs &tcs, T theta) {                 \
+                    return tcs.member(theta);                           \
+               }                                                        \
+          };
+
+          RODRIGUES_COEFFICIENT_SELECTOR(A0, a0)
+          RODRIGUES_COEFFICIENT_SELECTOR(A1, a1)
+          RODRIGUES_COEFFICIENT_SELECTOR(A2, a2)
+          RODRIGUES_COEFFICIENT_SELECTOR(B0, b0)
+          RODRIGUES_COEFFICIENT_SELECTOR(B1, b1)
+          RODRIGUES_COEFFICIENT_SELECTOR(B2, b2)
+
+#undef RODRIGUES_COEFFICIENT_SELECTOR
+     }
+
+     /**
+      * @brief Compile-time list of coefficient selectors
+      */
+     template < class... Coeffs > struct CoefficientList
+     {
+          static const std::size_t SIZE = sizeof...(Coeffs);
+
+          /**
+           * @brief Calls f(Coeff()) for every coefficient, in order
+           */
+          template < class F > static void for_each(F &f) {
+               int expand[] = { 0, (f(Coeffs()), 0)... };
+               (void) expand;
+          }
+     };
+
+     typedef CoefficientList<coefficient::A0, coefficient::A1, coefficient::A2,
+                             coefficient::B0, coefficient::B1, coefficient::B2> AllCoefficients;
+
+     namespace detail
+     {
+          template < std::size_t I, std::size_t N > struct TupleForEach
+          {
+               template < class Tuple, class F > static void apply(Tuple &t, F &f) {
+                    f(std::get<I>(t));
+                    TupleForEach<I + 1, N>::apply(t, f);
+               }
+          };
+
+          template < std::size_t N > struct TupleForEach<N, N>
+          {
+               template < class Tuple, class F > static void apply(Tuple &, F &) { }
+          };
+
+          template < class TCs, class F > struct PairVisitor
+          {
+               TCs &tcs;
+               F &f;
+               template < class Coeff > void operator()(Coeff c) {
+                    f(tcs, c);
+               }
+          };
+
+          template < class Coeffs, class F > struct TechniqueVisitor
+          {
+               F &f;
+               template < class TCs > void operator()(TCs &tcs) {
+                    PairVisitor<TCs, F> v{ tcs, f };
+                    Coeffs::for_each(v);
+               }
+          };
+     }
+
+     /**
+      * @brief Compile-time registry of techniques (TrigonometricCoeffs instances) and coefficients.
+      *
+      * The techniques are stored by value in a tuple and visited statically, so every evaluation
+      * reached through the registry is a direct call the compiler can inline, as opposed to
+      * storing the coefficients in type-erased std::function objects.
+      */
+     template < class Coeffs, class... Techniques > class CoefficientRegistry
+     {
+     public:
+          typedef std::tuple<Techniques...> Tuple;
+          typedef Coeffs Coefficients;
+          static const std::size_t N_TECHNIQUES = sizeof...(Techniques);
+
+          template < std::size_t I > typename std::tuple_element<I, Tuple>::type &get() {
+               return std::get<I>(m_techniques);
+          }
+
+          /**
+           * @brief Calls f(technique) for every technique
+           */
+          template < class F > void for_each_technique(F &f) {
+               detail::TupleForEach<0, N_TECHNIQUES>::apply(m_techniques, f);
+          }
+
+          /**
+           * @brief Calls f(technique, Coeff()) for every technique and coefficient
+           */
+          template < class F > void for_each(F &f) {
+               detail::TechniqueVisitor<Coeffs, F> v{ f };
+               for_each_technique(v);
+          }
+
+     protected:
+          Tuple m_techniques;
+     };
+
+}
+
+#endif
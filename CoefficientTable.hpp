@@ -0,0 +1,231 @@
+#ifndef _coefficient_table_h
+#define _coefficient_table_h
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+namespace rodrigues_formula
+{
+
+     /**
+      * @brief Ritto-Correa's coefficients as power series in u = theta^2, evaluated in long double.
+      *
+      * Level 0, 1 and 2 are the a_i, b_i and c_i coefficients:
+      *
+      *   level_k,i(u) = \sum_{j >= k} (-1)^j P_k(j) u^{j - k} / (2j + i)!,  P_k(j) = \prod_{m < k} (2j - 2m)
+      *
+      * and d(level_k,i)/du = level_k+1,i / 2, which gives the derivatives needed for Hermite
+      * interpolation in u of any level. Terms are summed until they no longer contribute, which
+      * keeps the series accurate up to |theta| ~ 2 pi.
+      */
+     inline long double series_coefficient(unsigned k, unsigned i, long double u)
+     {
+          long double inv_fact = 1;
+          for (unsigned n = 2; n <= 2 * k + i; ++n) inv_fact /= n;
+          long double u_pow = 1, sum = 0;
+          for (unsigned j = k; j < k + 80; ++j)
+          {
+               long double p = 1;
+               for (unsigned m = 0; m < k; ++m) p *= 2 * j - 2 * m;
+               const long double term = ((j % 2) ? -p : p) * u_pow * inv_fact;
+               sum += term;
+               if (j > k + 4 && std::fabs(term) <= 1e-24L * std::fabs(sum)) break;
+               u_pow *= u;
+               inv_fact /= (2 * j + i + 1) * (2 * j + i + 2);
+          }
+          return sum;
+     }
+
+     namespace detail
+     {
+          /**
+           * @brief Integer part of x >= 0. The types with no conversion to unsigned (e.g.
+           * DoubleDouble) go through long double; float and double convert directly.
+           */
+          template < typename T > unsigned table_index(T x)
+          {
+               return static_cast<unsigned>(static_cast<long double>(x));
+          }
+
+          inline unsigned table_index(float x) { return static_cast<unsigned>(x); }
+          inline unsigned table_index(double x) { return static_cast<unsigned>(x); }
+
+          /**
+           * @brief x rounded to T. Types wider than double take it as two doubles, so that the
+           * ones built from doubles (e.g. DoubleDouble, which only converts from double) keep
+           * every bit of x.
+           */
+          template < typename T > T from_long_double(long double x, std::false_type)
+          {
+               return static_cast<T>(x);
+          }
+
+          template < typename T > T from_long_double(long double x, std::true_type)
+          {
+               const double hi = static_cast<double>(x);
+               return T(hi) + T(static_cast<double>(x - hi));
+          }
+
+          template < typename T > T from_long_double(long double x)
+          {
+               return from_long_double<T>(x, std::integral_constant<bool, (std::numeric_limits<T>::digits >
+                                                                           std::numeric_limits<double>::digits)>());
+          }
+     }
+
+     /**
+      * @brief Lookup table of a0..a2, b0..b2, c0..c2 on a uniform grid in u = theta^2.
+      *
+      * As every coefficient is an even function of theta, tabulating in u covers negative angles
+      * for free and keeps the functions smooth at 0. Each interval stores the cubic Hermite
+      * interpolant of every coefficient as a polynomial in the local coordinate t in [0, 1), built
+      * from the exact values and u-derivatives at the nodes. An evaluation is thus one
+      * multiplication for u, the interval lookup and a 3-step Horner recurrence. Records of the
+      * same coefficient are contiguous: a table of a few hundred intervals fits in L1/L2.
+      *
+      * The number of intervals is doubled until the measured error meets the tolerance (or
+      * max_intervals is reached). The error is measured in T, against series_coefficient(), at the
+      * quarter points of every interval and relative to the largest magnitude of the coefficient
+      * over the range.
+      *
+      * T may be any of the supported real types. The table is built from long double values, which
+      * bounds its accuracy for the types wider than long double (DoubleDouble, __float128).
+      */
+     template < typename T > class CoefficientTable
+     {
+     public:
+          static const unsigned N_COEFFS = 9;
+
+          CoefficientTable(long double theta_max, long double tolerance, unsigned max_intervals = 1u << 16) :
+               m_theta_max(theta_max), m_tolerance(tolerance), m_u_max(theta_max * theta_max) {
+               for (unsigned c = 0; c < N_COEFFS; ++c)
+               {
+                    m_scale[c] = 0;
+               }
+               for (m_n = 16; ; m_n *= 2)
+               {
+                    build();
+                    m_max_error = measure();
+                    if (m_max_error <= m_tolerance || m_n >= max_intervals) break;
+               }
+          }
+
+          /**
+           * @brief True if theta lies in the tabulated range. Otherwise eval() must not be used.
+           */
+          bool contains(T theta) const {
+               return theta * theta < m_u_max_t;
+          }
+
+          /**
+           * @brief Interpolated coefficient: 0..2 a_i, 3..5 b_i, 6..8 c_i
+           */
+          T eval(unsigned coeff, T theta) const {
+               const T x = theta * theta * m_inv_h;
+               const unsigned idx = std::min(detail::table_index(x), m_n - 1);
+               const T t = x - static_cast<T>(idx);
+               const std::array<T, 4> &p = m_poly[coeff * m_n + idx];
+               return ((p[3] * t + p[2]) * t + p[1]) * t + p[0];
+          }
+
+          /**
+           * @brief All the coefficients, in the eval() order, sharing the interval lookup
+           */
+          void eval_all(T theta, T out[N_COEFFS]) const {
+               const T x = theta * theta * m_inv_h;
+               const unsigned idx = std::min(detail::table_index(x), m_n - 1);
+               const T t = x - static_cast<T>(idx);
+               for (unsigned c = 0; c < N_COEFFS; ++c)
+               {
+                    const std::array<T, 4> &p = m_poly[c * m_n + idx];
+                    out[c] = ((p[3] * t + p[2]) * t + p[1]) * t + p[0];
+               }
+          }
+
+          long double theta_max() const { return m_theta_max; }
+          long double tolerance() const { return m_tolerance; }
+          long double max_error() const { return m_max_error; }
+          unsigned intervals() const { return m_n; }
+          bool tolerance_met() const { return m_max_error <= m_tolerance; }
+          std::size_t bytes() const { return m_poly.size() * sizeof(m_poly[0]); }
+
+          void report(std::ostream &out) const {
+               out << "Coefficient table: |theta| < " << static_cast<double>(m_theta_max)
+                   << ", " << m_n << " intervals in theta^2 (" << bytes() << " bytes), max relative error "
+                   << static_cast<double>(m_max_error) << (tolerance_met() ? " <= " : " > ")
+                   << "tolerance " << static_cast<double>(m_tolerance) << "\n";
+          }
+
+     protected:
+          long double m_theta_max, m_tolerance, m_u_max;
+          T m_u_max_t, m_inv_h;
+          unsigned m_n;
+          long double m_max_error;
+          long double m_scale[N_COEFFS];
+          /// Interpolation polynomial coefficients, [coeff][interval]
+          std::vector<std::array<T, 4>> m_poly;
+
+          static long double exact(unsigned coeff, long double u) {
+               return series_coefficient(coeff / 3, coeff % 3, u);
+          }
+
+          static long double exact_du(unsigned coeff, long double u) {
+               return series_coefficient(coeff / 3 + 1, coeff % 3, u) / 2;
+          }
+
+          void build() {
+               const long double h = m_u_max / m_n;
+               m_inv_h = detail::from_long_double<T>(m_n / m_u_max);
+               m_u_max_t = detail::from_long_double<T>(m_u_max);
+               m_poly.assign(N_COEFFS * m_n, std::array<T, 4>());
+               for (unsigned c = 0; c < N_COEFFS; ++c)
+               {
+                    long double f0 = exact(c, 0), m0 = h * exact_du(c, 0);
+                    m_scale[c] = std::fabs(f0);
+                    for (unsigned j = 0; j < m_n; ++j)
+                    {
+                         const long double u1 = m_u_max * (j + 1) / m_n;
+                         const long double f1 = exact(c, u1), m1 = h * exact_du(c, u1);
+                         m_scale[c] = std::max(m_scale[c], std::fabs(f1));
+                         std::array<T, 4> &p = m_poly[c * m_n + j];
+                         p[0] = detail::from_long_double<T>(f0);
+                         p[1] = detail::from_long_double<T>(m0);
+                         p[2] = detail::from_long_double<T>(3 * (f1 - f0) - 2 * m0 - m1);
+                         p[3] = detail::from_long_double<T>(2 * (f0 - f1) + m0 + m1);
+                         f0 = f1;
+                         m0 = m1;
+                    }
+               }
+          }
+
+          long double measure() const {
+               long double worst = 0;
+               for (unsigned j = 0; j < m_n; ++j)
+               {
+                    for (unsigned q = 1; q < 4; ++q)
+                    {
+                         const long double u = m_u_max * (j + q / 4.0L) / m_n;
+                         const T theta = detail::from_long_double<T>(std::sqrt(u));
+                         const long double theta_l = static_cast<long double>(theta);
+                         const long double u_t = theta_l * theta_l;
+                         for (unsigned c = 0; c < N_COEFFS; ++c)
+                         {
+                              const long double value = static_cast<long double>(eval(c, theta));
+                              const long double err = std::fabs(value - exact(c, u_t)) / m_scale[c];
+                              worst = std::max(worst, err);
+                         }
+                    }
+               }
+               return worst;
+          }
+     };
+
+}
+
+#endif
@@ -0,0 +1,242 @@
+#ifndef _columnar_writer_h
+#define _columnar_writer_h
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace rodrigues_formula
+{
+
+     /**
+      * @brief numpy-style type descriptor ("<f4", "<f8", ...) of a column element type
+      */
+     template < typename T > struct ColumnType;
+
+     namespace detail
+     {
+          inline char byte_order_char()
+          {
+               const std::uint16_t probe = 1;
+               char first;
+               std::memcpy(&first, &probe, 1);
+               return first ? '<' : '>';
+          }
+     }
+
+     template <> struct ColumnType<float>
+     {
+          static std::string descr() { return std::string(1, detail::byte_order_char()) + "f4"; }
+     };
+
+     template <> struct ColumnType<double>
+     {
+          static std::string descr() { return std::string(1, detail::byte_order_char()) + "f8"; }
+     };
+
+     /**
+      * @brief Writer of the self-describing binary columnar format.
+      *
+      * All the values are stored in host byte order. The file starts with a header:
+      *
+      *   char     magic[8]      "RCCOLUMN"
+      *   uint32   version       1
+      *   uint32   n_columns
+      *   uint64   n_rows
+      *   uint64   header_size   Offset of the first column data: end of the directory, padded to
+      *                          ALIGNMENT bytes
+      *
+      * followed by one directory entry per column:
+      *
+      *   char     descr[8]      numpy type descriptor, NUL padded ("<f4", "<f8", ...)
+      *   uint64   offset        Offset of the column data from the beginning of the file
+      *   uint64   n_bytes       Size of the column data
+      *   uint32   name_len
+      *   char     name[name_len], NUL padded to a multiple of 8 bytes
+      *
+      * Column data is raw and contiguous, starting at ALIGNMENT-byte aligned offsets, so a column
+      * can be loaded without any parsing, e.g. with numpy.frombuffer / numpy.memmap.
+      *
+      * Columns are not copied: the caller keeps the data alive until write() returns, which sends
+      * header and columns to the file descriptor with a few large writev() calls.
+      */
+     class ColumnarWriter
+     {
+     public:
+          static const std::uint32_t VERSION = 1;
+          static const std::size_t ALIGNMENT = 64;
+
+          template < typename T >
+          void add_column(const std::string &name, const T *data, std::uint64_t n_rows) {
+               if (!m_columns.empty() && n_rows != m_n_rows)
+               {
+                    throw std::invalid_argument("column " + name + " has a different number of rows");
+               }
+               m_n_rows = n_rows;
+               m_columns.push_back(Column{ name, ColumnType<T>::descr(), data, n_rows * sizeof(T) });
+          }
+
+          /**
+           * @brief Writes the file into the given path, truncating it.
+           */
+          void write(const std::string &path) const {
+               const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+               if (fd < 0)
+               {
+                    throw std::system_error(errno, std::generic_category(), "cannot open " + path);
+               }
+               try
+               {
+                    write(fd);
+               }
+               catch (...)
+               {
+                    ::close(fd);
+                    throw;
+               }
+               if (::close(fd) != 0)
+               {
+                    throw std::system_error(errno, std::generic_category(), "cannot close " + path);
+               }
+          }
+
+          /**
+           * @brief Writes the file into an already open descriptor (e.g. STDOUT_FILENO)
+           */
+          void write(int fd) const {
+               std::vector<char> header = this->header();
+               static const char ZEROS[ALIGNMENT] = { 0 };
+
+               std::vector<iovec> iov;
+               iov.push_back(iovec{ header.data(), header.size() });
+               std::uint64_t pos = header.size();
+               for (const auto &c : m_columns)
+               {
+                    const std::uint64_t pad = padding(pos);
+                    if (pad) iov.push_back(iovec{ const_cast<char *>(ZEROS), pad });
+                    if (c.n_bytes) iov.push_back(iovec{ const_cast<void *>(c.data), c.n_bytes });
+                    pos += pad + c.n_bytes;
+               }
+               write_all(fd, iov);
+          }
+
+          /**
+           * @brief Header and column directory, as written at the beginning of the file
+           */
+          std::vector<char> header() const {
+               std::vector<char> buf;
+               const char MAGIC[8] = { 'R', 'C', 'C', 'O', 'L', 'U', 'M', 'N' };
+               buf.insert(buf.end(), MAGIC, MAGIC + 8);
+               put(buf, std::uint32_t(VERSION));
+               put(buf, static_cast<std::uint32_t>(m_columns.size()));
+               put(buf, m_n_rows);
+               const std::size_t header_size_pos = buf.size();
+               put(buf, std::uint64_t(0));
+
+               std::vector<std::size_t> offset_pos;
+               for (const auto &c : m_columns)
+               {
+                    char descr[8] = { 0 };
+                    std::memcpy(descr, c.descr.data(), std::min<std::size_t>(c.descr.size(), 8));
+                    buf.insert(buf.end(), descr, descr + 8);
+                    offset_pos.push_back(buf.size());
+                    put(buf, std::uint64_t(0));
+                    put(buf, c.n_bytes);
+                    put(buf, static_cast<std::uint32_t>(c.name.size()));
+                    buf.insert(buf.end(), c.name.begin(), c.name.end());
+                    buf.resize(buf.size() + (8 - buf.size() % 8) % 8, 0);
+               }
+
+               // The first column starts after the padding that aligns the end of the directory
+               put_at(buf, header_size_pos, static_cast<std::uint64_t>(buf.size() + padding(buf.size())));
+               std::uint64_t pos = buf.size();
+               for (std::size_t i = 0; i < m_columns.size(); ++i)
+               {
+                    pos += padding(pos);
+                    put_at(buf, offset_pos[i], pos);
+                    pos += m_columns[i].n_bytes;
+               }
+               return buf;
+          }
+
+          /**
+           * @brief Offset of the data of the given column from the beginning of the file
+           */
+          std::uint64_t offset(std::size_t column) const {
+               std::uint64_t pos = header().size();
+               for (std::size_t i = 0; i <= column; ++i)
+               {
+                    pos += padding(pos);
+                    if (i < column) pos += m_columns[i].n_bytes;
+               }
+               return pos;
+          }
+
+     protected:
+          struct Column
+          {
+               std::string name;
+               std::string descr;
+               const void *data;
+               std::uint64_t n_bytes;
+          };
+
+          std::vector<Column> m_columns;
+          std::uint64_t m_n_rows = 0;
+
+          static std::uint64_t padding(std::uint64_t pos) {
+               return (ALIGNMENT - pos % ALIGNMENT) % ALIGNMENT;
+          }
+
+          template < typename T >
+          static void put(std::vector<char> &buf, const T &v) {
+               const char *p = reinterpret_cast<const char *>(&v);
+               buf.insert(buf.end(), p, p + sizeof(T));
+          }
+
+          template < typename T >
+          static void put_at(std::vector<char> &buf, std::size_t pos, const T &v) {
+               std::memcpy(&buf[pos], &v, sizeof(T));
+          }
+
+          /**
+           * @brief writev() loop coping with partial writes and the IOV_MAX limit
+           */
+          static void write_all(int fd, std::vector<iovec> &iov) {
+               std::size_t first = 0;
+               while (first < iov.size())
+               {
+                    const int count = static_cast<int>(std::min<std::size_t>(iov.size() - first, IOV_MAX));
+                    const ssize_t written = ::writev(fd, &iov[first], count);
+                    if (written < 0)
+                    {
+                         if (errno == EINTR) continue;
+                         throw std::system_error(errno, std::generic_category(), "writev failed");
+                    }
+                    std::size_t left = static_cast<std::size_t>(written);
+                    while (first < iov.size() && left >= iov[first].iov_len)
+                    {
+                         left -= iov[first].iov_len;
+                         ++first;
+                    }
+                    if (left)
+                    {
+                         iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + left;
+                         iov[first].iov_len -= left;
+                    }
+               }
+          }
+     };
+
+}
+
+#endif
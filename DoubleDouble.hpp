@@ -0,0 +1,438 @@
+#ifndef _double_double_h
+#define _double_double_h
+
+#include <cmath>
+#include <limits>
+#include <ostream>
+
+namespace rodrigues_formula
+{
+
+     /**
+      * @brief Extended precision types. Their math functions live here, found by argument
+      * dependent lookup, so that they do not hide the standard ones for the builtin types.
+      */
+     namespace multiprecision
+     {
+
+     namespace detail
+     {
+          /**
+           * @brief Error-free transformations: the result is the rounded operation and err the
+           * exact rounding error, i.e. a op b = result + err exactly.
+           */
+          inline double two_sum(double a, double b, double &err)
+          {
+               const double s = a + b;
+               const double bb = s - a;
+               err = (a - (s - bb)) + (b - bb);
+               return s;
+          }
+
+          /// Same as two_sum() for |a| >= |b|
+          inline double quick_two_sum(double a, double b, double &err)
+          {
+               const double s = a + b;
+               err = b - (s - a);
+               return s;
+          }
+
+          inline double two_prod(double a, double b, double &err)
+          {
+               const double p = a * b;
+#ifdef FP_FAST_FMA
+               err = std::fma(a, b, -p);
+#else
+               // Dekker's product, for targets without a hardware FMA
+               const double SPLITTER = 134217729.0; // 2^27 + 1
+               double t = SPLITTER * a;
+               const double a_hi = t - (t - a), a_lo = a - a_hi;
+               t = SPLITTER * b;
+               const double b_hi = t - (t - b), b_lo = b - b_hi;
+               err = ((a_hi * b_hi - p) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo;
+#endif
+               return p;
+          }
+     }
+
+     /**
+      * @brief Double-double number: an unevaluated sum hi + lo of two doubles with |lo| <= ulp(hi) / 2,
+      * which carries about 106 bits of significand with the exponent range of double.
+      *
+      * Arithmetic is built on the error-free transformations above (with an FMA for the products
+      * where the target has one), so it only needs IEEE double arithmetic in round-to-nearest: it
+      * must not be compiled with -ffast-math. The type provides the operators and the math
+      * functions used by TrigonometricCoeffsImpl and Hyperdual (sin, cos, pow, exp, log, sqrt,
+      * fabs), so it can be used as T there, typically to compute accurate reference values much
+      * faster than a software quad precision type.
+      *
+      * sin and cos reduce the argument by pi / 2 with a three-double constant, which is accurate
+      * for |x| up to about 1e15.
+      */
+     class DoubleDouble
+     {
+     public:
+          constexpr DoubleDouble() : m_hi(0), m_lo(0) { }
+          constexpr DoubleDouble(double hi) : m_hi(hi), m_lo(0) { }
+          constexpr DoubleDouble(double hi, double lo) : m_hi(hi), m_lo(lo) { }
+
+          double hi() const { return m_hi; }
+          double lo() const { return m_lo; }
+
+          explicit operator double() const { return m_hi + m_lo; }
+          explicit operator float() const { return static_cast<float>(m_hi + m_lo); }
+          explicit operator long double() const {
+               return static_cast<long double>(m_hi) + static_cast<long double>(m_lo);
+          }
+
+          /**
+           * @brief hi + lo normalised, for |hi| >= |lo|
+           */
+          static DoubleDouble normalise(double hi, double lo) {
+               double e;
+               const double s = detail::quick_two_sum(hi, lo, e);
+               return DoubleDouble(s, e);
+          }
+
+          DoubleDouble operator-() const { return DoubleDouble(-m_hi, -m_lo); }
+
+          DoubleDouble &operator+=(const DoubleDouble &rhs);
+          DoubleDouble &operator-=(const DoubleDouble &rhs);
+          DoubleDouble &operator*=(const DoubleDouble &rhs);
+          DoubleDouble &operator/=(const DoubleDouble &rhs);
+
+     protected:
+          double m_hi, m_lo;
+     };
+
+     inline DoubleDouble operator+(const DoubleDouble &a, const DoubleDouble &b)
+     {
+          double e, f;
+          double s = detail::two_sum(a.hi(), b.hi(), e);
+          const double t = detail::two_sum(a.lo(), b.lo(), f);
+          e += t;
+          s = detail::quick_two_sum(s, e, e);
+          e += f;
+          return DoubleDouble::normalise(s, e);
+     }
+
+     inline DoubleDouble operator+(const DoubleDouble &a, double b)
+     {
+          double e;
+          const double s = detail::two_sum(a.hi(), b, e);
+          return DoubleDouble::normalise(s, e + a.lo());
+     }
+
+     inline DoubleDouble operator+(double a, const DoubleDouble &b) { return b + a; }
+     inline DoubleDouble operator-(const DoubleDouble &a, const DoubleDouble &b) { return a + (-b); }
+     inline DoubleDouble operator-(const DoubleDouble &a, double b) { return a + (-b); }
+     inline DoubleDouble operator-(double a, const DoubleDouble &b) { return (-b) + a; }
+
+     inline DoubleDouble operator*(const DoubleDouble &a, const DoubleDouble &b)
+     {
+          double e;
+          const double p = detail::two_prod(a.hi(), b.hi(), e);
+          e += a.hi() * b.lo() + a.lo() * b.hi();
+          return DoubleDouble::normalise(p, e);
+     }
+
+     inline DoubleDouble operator*(const DoubleDouble &a, double b)
+     {
+          double e;
+          const double p = detail::two_prod(a.hi(), b, e);
+          e += a.lo() * b;
+          return DoubleDouble::normalise(p, e);
+     }
+
+     inline DoubleDouble operator*(double a, const DoubleDouble &b) { return b * a; }
+
+     inline DoubleDouble operator/(const DoubleDouble &a, const DoubleDouble &b)
+     {
+          // Long division: three quotient digits, each one from the remainder of the previous
+          const double q1 = a.hi() / b.hi();
+          DoubleDouble r = a - b * q1;
+          const double q2 = r.hi() / b.hi();
+          r -= b * q2;
+          const double q3 = r.hi() / b.hi();
+          return DoubleDouble::normalise(q1, q2) + q3;
+     }
+
+     inline DoubleDouble operator/(const DoubleDouble &a, double b) { return a / DoubleDouble(b); }
+     inline DoubleDouble operator/(double a, const DoubleDouble &b) { return DoubleDouble(a) / b; }
+
+     inline DoubleDouble &DoubleDouble::operator+=(const DoubleDouble &rhs) { return *this = *this + rhs; }
+     inline DoubleDouble &DoubleDouble::operator-=(const DoubleDouble &rhs) { return *this = *this - rhs; }
+     inline DoubleDouble &DoubleDouble::operator*=(const DoubleDouble &rhs) { return *this = *this * rhs; }
+     inline DoubleDouble &DoubleDouble::operator/=(const DoubleDouble &rhs) { return *this = *this / rhs; }
+
+#define RODRIGUES_DD_COMPARISON(op)                                                  \
+     inline bool operator op(const DoubleDouble &a, const DoubleDouble &b) {         \
+          return a.hi() == b.hi() ? a.lo() op b.lo() : a.hi() op b.hi();             \
+     }                                                                               \
+     inline bool operator op(const DoubleDouble &a, double b) { return a op DoubleDouble(b); } \
+     inline bool operator op(double a, const DoubleDouble &b) { return DoubleDouble(a) op b; }
+
+     RODRIGUES_DD_COMPARISON(<)
+     RODRIGUES_DD_COMPARISON(<=)
+     RODRIGUES_DD_COMPARISON(>)
+     RODRIGUES_DD_COMPARISON(>=)
+     RODRIGUES_DD_COMPARISON(==)
+     RODRIGUES_DD_COMPARISON(!=)
+
+#undef RODRIGUES_DD_COMPARISON
+
+     inline bool isfinite(const DoubleDouble &a) { return std::isfinite(a.hi()); }
+     inline bool isnan(const DoubleDouble &a) { return std::isnan(a.hi()); }
+
+     inline DoubleDouble fabs(const DoubleDouble &a) { return a.hi() < 0 ? -a : a; }
+
+     inline DoubleDouble ldexp(const DoubleDouble &a, int e)
+     {
+          return DoubleDouble(std::ldexp(a.hi(), e), std::ldexp(a.lo(), e));
+     }
+
+     inline DoubleDouble sqrt(const DoubleDouble &a)
+     {
+          if (!(a.hi() > 0)) return DoubleDouble(std::sqrt(a.hi()));
+          // One Newton step from the double precision result (Karp's trick)
+          const double x = 1.0 / std::sqrt(a.hi());
+          const double ax = a.hi() * x;
+          double e;
+          const double ax2 = detail::two_prod(ax, ax, e);
+          const double d = (a - DoubleDouble(ax2, e)).hi();
+          double f;
+          const double s = detail::two_sum(ax, d * x * 0.5, f);
+          return DoubleDouble::normalise(s, f);
+     }
+
+     /**
+      * @brief x^n by binary powering
+      */
+     inline DoubleDouble pow(const DoubleDouble &x, int n)
+     {
+          DoubleDouble r(1), b(x);
+          for (unsigned m = n < 0 ? -static_cast<unsigned>(n) : static_cast<unsigned>(n); m; m >>= 1)
+          {
+               if (m & 1) r *= b;
+               if (m > 1) b *= b;
+          }
+          return n < 0 ? 1.0 / r : r;
+     }
+
+     namespace detail
+     {
+          /// 1 / n! for n < N_INV_FACTORIALS, in double-double
+          static const int DD_N_INV_FACTORIALS = 32;
+
+          inline const DoubleDouble *dd_inv_factorials()
+          {
+               struct Table
+               {
+                    DoubleDouble v[DD_N_INV_FACTORIALS];
+                    Table() {
+                         v[0] = 1;
+                         for (int n = 1; n < DD_N_INV_FACTORIALS; ++n) v[n] = v[n - 1] / double(n);
+                    }
+               };
+               static const Table t;
+               return t.v;
+          }
+
+          const double DD_EPS = 1.2325951644078309e-32; // 2^-106
+
+          /**
+           * @brief sin(r) and cos(r) by their Taylor series, for |r| <= pi / 4
+           */
+          inline void dd_sincos_taylor(const DoubleDouble &r, DoubleDouble &s, DoubleDouble &c)
+          {
+               const DoubleDouble *inv_fact = dd_inv_factorials();
+               DoubleDouble p = r;  // r^n
+               s = r;
+               c = 1;
+               for (int n = 2; n < DD_N_INV_FACTORIALS - 1; n += 2)
+               {
+                    p *= r;
+                    const double sign = (n & 2) ? -1 : 1;
+                    const DoubleDouble tc = p * inv_fact[n] * sign;
+                    p *= r;
+                    const DoubleDouble ts = p * inv_fact[n + 1] * sign;
+                    c += tc;
+                    s += ts;
+                    if (std::fabs(tc.hi()) <= DD_EPS * std::fabs(c.hi()) &&
+                        std::fabs(ts.hi()) <= DD_EPS * std::fabs(s.hi())) break;
+               }
+          }
+
+          /**
+           * @brief Reduces x to r in [-pi / 4, pi / 4] with x = r + k pi / 2, returns k mod 4
+           */
+          inline int dd_reduce_pio2(const DoubleDouble &x, DoubleDouble &r)
+          {
+               const double PIO2_1 = 1.5707963267948966e+00;
+               const double PIO2_2 = 6.123233995736766e-17;
+               const double PIO2_3 = -1.4973849048591698e-33;
+               const double k = std::nearbyint(x.hi() / PIO2_1);
+               double e1, e2;
+               const double p1 = two_prod(k, PIO2_1, e1);
+               const double p2 = two_prod(k, PIO2_2, e2);
+               r = x - DoubleDouble(p1, e1);
+               r -= DoubleDouble(p2, e2);
+               r -= k * PIO2_3;
+               return static_cast<int>(std::fmod(k, 4.0) + 4) % 4;
+          }
+
+          inline void dd_sincos(const DoubleDouble &x, DoubleDouble &s, DoubleDouble &c)
+          {
+               if (!std::isfinite(x.hi()))
+               {
+                    s = c = std::numeric_limits<double>::quiet_NaN();
+                    return;
+               }
+               DoubleDouble r, sr, cr;
+               const int q = dd_reduce_pio2(x, r);
+               dd_sincos_taylor(r, sr, cr);
+               switch (q)
+               {
+               case 0: s = sr; c = cr; break;
+               case 1: s = cr; c = -sr; break;
+               case 2: s = -sr; c = -cr; break;
+               default: s = -cr; c = sr; break;
+               }
+          }
+     }
+
+     inline DoubleDouble sin(const DoubleDouble &x)
+     {
+          DoubleDouble s, c;
+          detail::dd_sincos(x, s, c);
+          return s;
+     }
+
+     inline DoubleDouble cos(const DoubleDouble &x)
+     {
+          DoubleDouble s, c;
+          detail::dd_sincos(x, s, c);
+          return c;
+     }
+
+     namespace detail
+     {
+          /**
+           * @brief expm1(x - k ln 2) with k = nearbyint(x / ln 2), for finite x in the range of exp
+           */
+          inline DoubleDouble dd_expm1_reduced(const DoubleDouble &x, double &k)
+          {
+               // x = k ln 2 + r, exp(r) = exp(r / 2^9)^(2^9)
+               const DoubleDouble LN2(6.9314718055994529e-01, 2.3190468138462996e-17);
+               k = std::nearbyint(x.hi() / LN2.hi());
+               const DoubleDouble r = ldexp(x - LN2 * k, -9);
+               const DoubleDouble *inv_fact = dd_inv_factorials();
+               // expm1(r), |r| < 7e-4
+               DoubleDouble p = r, sum = r;
+               for (int n = 2; n < DD_N_INV_FACTORIALS; ++n)
+               {
+                    p *= r;
+                    const DoubleDouble t = p * inv_fact[n];
+                    sum += t;
+                    if (std::fabs(t.hi()) <= DD_EPS * std::fabs(sum.hi())) break;
+               }
+               // (1 + e)^2 - 1 = e (2 + e), which keeps the small expm1 value accurate
+               for (int i = 0; i < 9; ++i) sum = sum * (sum + 2.0);
+               return sum;
+          }
+     }
+
+     inline DoubleDouble exp(const DoubleDouble &x)
+     {
+          if (x.hi() > 709.8) return std::numeric_limits<double>::infinity();
+          if (x.hi() < -745.2) return 0.0;
+          if (std::isnan(x.hi())) return x;
+          double k;
+          const DoubleDouble e = detail::dd_expm1_reduced(x, k);
+          return ldexp(e + 1.0, static_cast<int>(k));
+     }
+
+     /**
+      * @brief exp(x) - 1, without the cancellation of the subtraction for |x| < ln(2) / 2
+      */
+     inline DoubleDouble expm1(const DoubleDouble &x)
+     {
+          if (x.hi() > 709.8) return std::numeric_limits<double>::infinity();
+          if (x.hi() < -80) return -1.0;
+          if (std::isnan(x.hi())) return x;
+          double k;
+          const DoubleDouble e = detail::dd_expm1_reduced(x, k);
+          return k == 0 ? e : ldexp(e + 1.0, static_cast<int>(k)) - 1.0;
+     }
+
+     inline DoubleDouble log(const DoubleDouble &x)
+     {
+          if (!(x.hi() > 0) || !std::isfinite(x.hi())) return std::log(x.hi());
+          // Newton step on exp(y) = x from the double precision result
+          const DoubleDouble y = std::log(x.hi());
+          return y + x * exp(-y) - 1.0;
+     }
+
+     /**
+      * @brief log(1 + x), without rounding 1 + x
+      */
+     inline DoubleDouble log1p(const DoubleDouble &x)
+     {
+          if (!(x.hi() > -1) || !std::isfinite(x.hi())) return std::log1p(x.hi());
+          // Newton step on expm1(y) = x from the double precision result
+          const DoubleDouble y = std::log1p(x.hi());
+          const DoubleDouble e = expm1(y);
+          return y + (x - e) / (e + 1.0);
+     }
+
+     /**
+      * @brief x^y; integer exponents are computed exactly by pow(x, int)
+      */
+     inline DoubleDouble pow(const DoubleDouble &x, const DoubleDouble &y)
+     {
+          if (y.lo() == 0 && y.hi() == std::floor(y.hi()) && std::fabs(y.hi()) < 1024)
+          {
+               return pow(x, static_cast<int>(y.hi()));
+          }
+          return exp(y * log(x));
+     }
+
+     inline DoubleDouble pow(const DoubleDouble &x, double y) { return pow(x, DoubleDouble(y)); }
+
+     inline std::ostream &operator<<(std::ostream &out, const DoubleDouble &a)
+     {
+          // Through long double: enough for reports, not a full 32 digits conversion
+          return out << static_cast<long double>(a);
+     }
+
+     }
+
+     using multiprecision::DoubleDouble;
+
+}
+
+namespace std
+{
+     template <> class numeric_limits<rodrigues_formula::DoubleDouble> : public numeric_limits<double>
+     {
+     public:
+          static const int digits = 104;
+          static const int digits10 = 31;
+          static const int max_digits10 = 33;
+
+          static rodrigues_formula::DoubleDouble epsilon() {
+               return rodrigues_formula::DoubleDouble(4.93038065763132e-32); // 2^-104
+          }
+          static rodrigues_formula::DoubleDouble min() {
+               return rodrigues_formula::DoubleDouble(2.0041683600089728e-292); // 2^-968: lo stays normal
+          }
+          static rodrigues_formula::DoubleDouble max() {
+               return rodrigues_formula::DoubleDouble(1.79769313486231570815e+308, 9.97920154767359795037e+291);
+          }
+          static rodrigues_formula::DoubleDouble lowest() { return -max(); }
+          static rodrigues_formula::DoubleDouble infinity() { return numeric_limits<double>::infinity(); }
+          static rodrigues_formula::DoubleDouble quiet_NaN() { return numeric_limits<double>::quiet_NaN(); }
+     };
+}
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef _float128_h
+#define _float128_h
+
+/**
+ * @brief Support of the GCC __float128 type (IEEE binary128, software implementation) through
+ * libquadmath, enabled when CMake defines RODRIGUES_HAVE_FLOAT128.
+ *
+ * __float128 is a fundamental type, so argument dependent lookup finds nothing for it: the
+ * overloads below are declared in the global namespace, next to the <cmath> ones, and this header
+ * must be included before the templates that call them unqualified (Hyperdual.hpp,
+ * TrigonometricCoeffs.hpp).
+ */
+#ifdef RODRIGUES_HAVE_FLOAT128
+
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <quadmath.h>
+
+inline __float128 sin(__float128 x) { return sinq(x); }
+inline __float128 cos(__float128 x) { return cosq(x); }
+inline __float128 tan(__float128 x) { return tanq(x); }
+inline __float128 asin(__float128 x) { return asinq(x); }
+inline __float128 acos(__float128 x) { return acosq(x); }
+inline __float128 atan(__float128 x) { return atanq(x); }
+inline __float128 exp(__float128 x) { return expq(x); }
+inline __float128 log(__float128 x) { return logq(x); }
+inline __float128 expm1(__float128 x) { return expm1q(x); }
+inline __float128 log1p(__float128 x) { return log1pq(x); }
+inline __float128 sqrt(__float128 x) { return sqrtq(x); }
+inline __float128 fabs(__float128 x) { return fabsq(x); }
+inline __float128 ldexp(__float128 x, int e) { return ldexpq(x, e); }
+inline __float128 pow(__float128 x, __float128 y) { return powq(x, y); }
+/// Exact match for the integer powers of the direct expressions, preferred to the <cmath> templates
+inline __float128 pow(__float128 x, int n) { return powq(x, n); }
+inline bool isfinite(__float128 x) { return finiteq(x); }
+
+inline std::ostream &operator<<(std::ostream &out, __float128 x)
+{
+     char buf[64];
+     quadmath_snprintf(buf, sizeof(buf), "%.*Qe", static_cast<int>(out.precision()), x);
+     return out << buf;
+}
+
+namespace std
+{
+     template <> class numeric_limits<__float128> : public numeric_limits<double>
+     {
+     public:
+          static const int digits = FLT128_MANT_DIG;
+          static const int digits10 = FLT128_DIG;
+          static const int max_digits10 = 36;
+          static const int min_exponent = FLT128_MIN_EXP;
+          static const int max_exponent = FLT128_MAX_EXP;
+
+          // The FLT128_* constants use the Q literal suffix, not available in ISO C++ mode
+          static __float128 epsilon() { return ldexpq(1, 1 - FLT128_MANT_DIG); }
+          static __float128 min() { return ldexpq(1, FLT128_MIN_EXP - 1); }
+          static __float128 max() { return ldexpq(2 - epsilon(), FLT128_MAX_EXP - 1); }
+          static __float128 lowest() { return -max(); }
+          static __float128 denorm_min() { return ldexpq(1, FLT128_MIN_EXP - FLT128_MANT_DIG); }
+          static __float128 infinity() { return __builtin_huge_valq(); }
+          static __float128 quiet_NaN() { return nanq(""); }
+     };
+}
+
+#endif
+
+#endif
@@ -30,6 +30,7 @@
 
 #include <iostream>
 #include <math.h>
+#include "Instrumentation.hpp"
 
 /**
  * @brief Implementation of hyper-dual numbers
@@ -58,20 +59,28 @@ public:
 
      // Basic manipulation
      Hyperdual<Real> operator+() const;
+     // The Real operands only touch the components they change, instead of being promoted to
+     // a Hyperdual with three zero parts
      Hyperdual<Real> operator+(const Hyperdual<Real> &rhs) const;
-     template<class R> friend Hyperdual operator+(const R lhs, const Hyperdual<R> &rhs);
+     Hyperdual<Real> operator+(Real rhs) const;
+     template<class R> friend Hyperdual<R> operator+(const R lhs, const Hyperdual<R> &rhs);
      Hyperdual<Real> operator-() const;
      Hyperdual<Real> operator-(const Hyperdual<Real> &rhs) const;
+     Hyperdual<Real> operator-(Real rhs) const;
      template<class R> friend Hyperdual<R> operator-(const R lhs, const Hyperdual<R> &rhs);
      Hyperdual<Real> operator*(const Hyperdual<Real> &rhs)const;
+     Hyperdual<Real> operator*(Real rhs) const;
      template<class R> friend Hyperdual<R> operator*(const R lhs, const Hyperdual<R> &rhs);
      template<class R> friend Hyperdual<R> operator/(const Hyperdual<R> &lhs, const Hyperdual<R> &rhs);
      template<class R> friend Hyperdual<R> operator/(const R lhs, const Hyperdual<R> &rhs);
      template<class R> friend Hyperdual<R> operator/(const Hyperdual<R> &lhs, const R rhs);
      Hyperdual<Real>& operator+=(const Hyperdual<Real> &rhs);
+     Hyperdual<Real>& operator+=(Real rhs);
      Hyperdual<Real>& operator-=(const Hyperdual<Real> &rhs);
+     Hyperdual<Real>& operator-=(Real rhs);
      Hyperdual<Real>& operator*=(const Hyperdual<Real> &rhs);
      Hyperdual<Real>& operator*=(Real rhs);
+     Hyperdual<Real>& operator/=(const Hyperdual<Real> &rhs);
      Hyperdual<Real>& operator/=(Real rhs);
 
      // math.h functions
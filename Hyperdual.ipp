@@ -90,6 +90,14 @@ Hyperdual<Real> Hyperdual<Real>::operator+(const Hyperdual<Real> &rhs) const
      return temp;
 }
 
+template<class Real>
+Hyperdual<Real> Hyperdual<Real>::operator+(Real rhs) const
+{
+	Hyperdual<Real> temp = *this;
+	temp.f0 += rhs;
+	return temp;
+}
+
 template<class Real>
 Hyperdual<Real> operator+(const Real lhs, const Hyperdual<Real> &rhs)
 {
@@ -123,6 +131,14 @@ Hyperdual<Real> Hyperdual<Real>::operator-(const Hyperdual<Real> &rhs) const
      return temp;
 }
 
+template<class Real>
+Hyperdual<Real> Hyperdual<Real>::operator-(Real rhs) const
+{
+	Hyperdual<Real> temp = *this;
+	temp.f0 -= rhs;
+	return temp;
+}
+
 template<class Real>
 Hyperdual<Real> operator-(const Real lhs, const Hyperdual<Real> &rhs)
 {
@@ -145,6 +161,17 @@ Hyperdual<Real> Hyperdual<Real>::operator* (const Hyperdual<Real> &rhs) const
 	return temp;
 }
 
+template<class Real>
+Hyperdual<Real> Hyperdual<Real>::operator*(Real rhs) const
+{
+	Hyperdual<Real> temp;
+	temp.f0 = f0*rhs;
+	temp.f1 = f1*rhs;
+	temp.f2 = f2*rhs;
+	temp.f12 = f12*rhs;
+	return temp;
+}
+
 template<class Real>
 Hyperdual<Real> operator*(const Real lhs, const Hyperdual<Real> &rhs)
 {
@@ -168,10 +195,7 @@ Hyperdual<Real> operator/(const Hyperdual<Real> &lhs, const Hyperdual<Real> &rhs
 template<class Real>
 Hyperdual<Real> operator/(const Real lhs, const Hyperdual<Real> &rhs)
 {
-	Hyperdual<Real> temp, inv;
-	inv = pow(rhs,-1);
-	temp = lhs*inv;
-	return temp;
+	return lhs*pow(rhs, Real(-1.0));
 }
 
 template<class Real>
@@ -197,6 +221,13 @@ Hyperdual<Real>& Hyperdual<Real>::operator+=(const Hyperdual<Real> &rhs)
 	return *this;
 }
 
+template<class Real>
+Hyperdual<Real>& Hyperdual<Real>::operator+=(Real rhs)
+{
+	f0 += rhs;
+	return *this;
+}
+
 template<class Real>
 Hyperdual<Real>& Hyperdual<Real>::operator-=(const Hyperdual<Real> &rhs)
 {
@@ -207,6 +238,13 @@ Hyperdual<Real>& Hyperdual<Real>::operator-=(const Hyperdual<Real> &rhs)
 	return *this;
 }
 
+template<class Real>
+Hyperdual<Real>& Hyperdual<Real>::operator-=(Real rhs)
+{
+	f0 -= rhs;
+	return *this;
+}
+
 template<class Real>
 Hyperdual<Real>& Hyperdual<Real>::operator*=(const Hyperdual<Real> &rhs)
 {
@@ -232,6 +270,12 @@ Hyperdual<Real>& Hyperdual<Real>::operator*=(Real rhs)
 	return *this;
 }
 
+template<class Real>
+Hyperdual<Real>& Hyperdual<Real>::operator/=(const Hyperdual<Real> &rhs)
+{
+	return *this = *this / rhs;
+}
+
 template<class Real>
 Hyperdual<Real>& Hyperdual<Real>::operator/=(Real rhs)
 {
@@ -251,6 +295,7 @@ Hyperdual<Real> pow(const Hyperdual<Real> &x, Real a)
 	tol = 1e-15;
 	if (fabs(xval) < tol)
 	{
+		RODRIGUES_COUNT(PowClamp);
 		if (xval >= 0)
 			xval = tol;
 		if (xval < 0)
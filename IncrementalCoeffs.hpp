@@ -0,0 +1,154 @@
+#ifndef _incremental_coeffs_h
+#define _incremental_coeffs_h
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include "TrigonometricCoeffs.hpp"
+
+namespace rodrigues_formula
+{
+
+     /**
+      * @brief Coefficients of an angle that changes by small increments, as in Newton iterations.
+      *
+      * The object keeps theta, sin(theta) and cos(theta) together with the coefficient bundle.
+      * update(delta) moves theta by delta and rotates (sin, cos) with the angle addition formulas,
+      * where sin(delta) and cos(delta) - 1 come from a short Taylor polynomial, so no
+      * transcendental function is called. The coefficients are then rebuilt without calling sin or
+      * cos either: up to the c_i series threshold, |theta| <= 1, from the a_i series evaluated in
+      * hyper-dual numbers (see the HyperDualSeries mode), which do not depend on sin and cos at
+      * all; beyond, from (theta, sin, cos) by the direct expressions.
+      *
+      * Error control: sin and cos are kept as unevaluated sums hi + lo, to which the increments
+      * sin (cos(delta) - 1) + cos sin(delta) and its cos counterpart, of magnitude |delta|, are
+      * added without losing the rounding error of the sums. Each update thus errs by a few ulps of
+      * |delta| instead of an ulp of sin and cos, so the error is bounded by the accumulated |delta|
+      * rather than by the number of updates, and hi errs like a fresh sin / cos evaluation as long
+      * as that accumulated |delta| stays small. sin(theta) and cos(theta) are recomputed from
+      * scratch whenever |delta| exceeds Policy::incremental_max_step (the Taylor polynomial is
+      * accurate to the precision of T up to it), when the |delta| accumulated since the last full
+      * evaluation would exceed Policy::incremental_max_drift, or after
+      * Policy::incremental_max_updates consecutive additions.
+      *
+      * The increment actually applied is the difference between the rounded new theta and the old
+      * one, so that sin and cos stay consistent with the stored theta.
+      */
+     template < typename T, class Policy = DefaultPolicy > class IncrementalCoeffs
+     {
+     public:
+          typedef CoefficientBundle<T> Bundle;
+
+          struct Stats
+          {
+               std::uint64_t incremental = 0;
+               std::uint64_t full = 0;
+
+               void report(std::ostream &out) const {
+                    out << incremental << " incremental updates, " << full << " full evaluations\n";
+               }
+          };
+
+          explicit IncrementalCoeffs(T theta) {
+               reset(theta);
+          }
+
+          /**
+           * @brief Full evaluation at theta
+           */
+          const Bundle &reset(T theta) {
+               m_theta = theta;
+               Policy::Math::sincos(theta, m_sin, m_cos);
+               m_sin_lo = m_cos_lo = T(0);
+               m_drift = T(0);
+               m_n_updates = 0;
+               ++m_stats.full;
+               return evaluate();
+          }
+
+          /**
+           * @brief Moves to theta + delta
+           */
+          const Bundle &update(T delta) {
+               const T theta = m_theta + delta;
+               const T d = theta - m_theta;
+               const T drift = m_drift + fabs(d);
+               T max_drift = Policy::template incremental_max_drift<T>();
+               // Beyond the threshold a0 = cos and a1 = sin / theta come straight from the sums:
+               // their relative accuracy near the zeros of sin and cos needs a smaller drift
+               if (detail::beyond<Policy>(theta, SeriesImpl::S_C_THRESHOLD))
+               {
+                    max_drift *= std::min(fabs(m_sin), fabs(m_cos));
+               }
+               if (!(fabs(d) <= Policy::template incremental_max_step<T>()) ||
+                   !(drift <= max_drift) ||
+                   m_n_updates >= Policy::incremental_max_updates())
+               {
+                    return reset(theta);
+               }
+
+               T sin_d, cos_d_m1;
+               small_sincos(d, sin_d, cos_d_m1);
+               const T ds = m_sin * cos_d_m1 + m_cos * sin_d;
+               const T dc = m_cos * cos_d_m1 - m_sin * sin_d;
+               accumulate(m_sin, m_sin_lo, ds);
+               accumulate(m_cos, m_cos_lo, dc);
+               m_theta = theta;
+               m_drift = drift;
+               ++m_n_updates;
+               ++m_stats.incremental;
+               return evaluate();
+          }
+
+          T theta() const { return m_theta; }
+          T sin_theta() const { return m_sin; }
+          T cos_theta() const { return m_cos; }
+          const Bundle &bundle() const { return m_bundle; }
+          const Stats &stats() const { return m_stats; }
+
+          /**
+           * @brief sin(d) and cos(d) - 1 for |d| <= 1/16, by their Taylor polynomials up to d^11
+           * and d^10: the first neglected terms are below 2^-64 relative. cos(d) - 1 is summed
+           * without its leading 1, so it keeps its relative accuracy.
+           */
+          static void small_sincos(T d, T &s, T &c_m1) {
+               const T d2 = d * d;
+               s = d * (T(1) - d2 / T(6) * (T(1) - d2 / T(20) * (T(1) - d2 / T(42) * (T(1) - d2 / T(72) * (T(1) - d2 / T(110))))));
+               c_m1 = -d2 / T(2) * (T(1) - d2 / T(12) * (T(1) - d2 / T(30) * (T(1) - d2 / T(56) * (T(1) - d2 / T(90)))));
+          }
+
+     protected:
+          typedef detail::TrigonometricCoeffsImpl<T, CalculationMode::HyperDualSeries, Policy> Impl;
+          typedef detail::TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion, Policy> SeriesImpl;
+
+          /// sin(theta) = m_sin + m_sin_lo and cos(theta) = m_cos + m_cos_lo, |lo| <= ulp(hi) / 2
+          T m_theta, m_sin, m_cos, m_sin_lo, m_cos_lo;
+          /// |delta| accumulated since the last full evaluation
+          T m_drift;
+          unsigned m_n_updates;
+          Bundle m_bundle;
+          Stats m_stats;
+
+          const Bundle &evaluate() {
+               m_bundle = Impl::bundle(m_theta, m_sin, m_cos);
+               return m_bundle;
+          }
+
+          /**
+           * @brief hi + lo += x, with the rounding error of hi + x kept in lo (Knuth's TwoSum)
+           * and the sum renormalised so that hi stays the rounded value
+           */
+          static void accumulate(T &hi, T &lo, T x) {
+               const T s = hi + x;
+               const T v = s - hi;
+               const T err = (hi - (s - v)) + (x - v);
+               const T l = lo + err;
+               hi = s + l;
+               lo = l - (hi - s);
+          }
+     };
+
+}
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef _instrumentation_h
+#define _instrumentation_h
+
+/**
+ * @brief Optional event counters, to see which regimes the calculation modes take on real data
+ * (e.g. to tune the series thresholds) and how often special cases occur.
+ *
+ * The counters are compiled in when RODRIGUES_INSTRUMENTATION is defined (CMake option of the same
+ * name). Otherwise RODRIGUES_COUNT(), RODRIGUES_COUNT_N() and RODRIGUES_COUNT_NON_FINITE() expand
+ * to nothing and the instrumented code is unchanged.
+ *
+ * The branch counters count coefficient values: a bundle adds one per coefficient to the branch
+ * that computed it. a0 is only counted by the HyperDualSeries mode, whose a0 switches between
+ * its series and cos(theta); elsewhere a0() is cos(theta). The HalfAngle mode counts its
+ * evaluations of b1 and c1 of the half angle instead. AdaptiveSeriesTerms adds up the lengths of
+ * the series that the AdaptiveSeries mode evaluates, to compare with AdaptiveSeriesTaken. The
+ * HyperDualSeries counters also count the da_i and d2a_i calls.
+ *
+ * Each thread increments its own counters (ThreadCounters.hpp), without synchronisation.
+ * Instrumentation::total() sums them over every thread that counted something, alive or already
+ * finished, and Instrumentation::report() prints the sums.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#ifdef RODRIGUES_INSTRUMENTATION
+#include "ThreadCounters.hpp"
+#endif
+
+namespace rodrigues_formula
+{
+
+     enum class Counter
+     {
+          /// SeriesExpansion: coefficient evaluated by its series
+          SeriesTaken,
+          /// SeriesExpansion: coefficient evaluated by its direct expression, above the threshold
+          SeriesDirectTaken,
+          /// MixedPrecision: coefficient evaluated by its series
+          MixedSeriesTaken,
+          /// MixedPrecision: coefficient evaluated by its direct expression (in T or the wider type)
+          MixedDirectTaken,
+          /// HalfAngle: b1 or c1 of the half angle evaluated by its series
+          HalfAngleSeriesTaken,
+          /// HalfAngle: b1 or c1 of the half angle evaluated by its direct expression
+          HalfAngleDirectTaken,
+          /// AdaptiveSeries: coefficient evaluated by its series
+          AdaptiveSeriesTaken,
+          /// AdaptiveSeries: coefficient evaluated by its direct expression
+          AdaptiveDirectTaken,
+          /// AdaptiveSeries: number of series terms chosen, summed over the evaluations
+          AdaptiveSeriesTerms,
+          /// HyperDualSeries: coefficient or derivative evaluated by the hyper-dual series
+          HyperDualSeriesTaken,
+          /// HyperDualSeries: coefficient or derivative evaluated by its direct expression
+          HyperDualDirectTaken,
+          /// Table: call outside the table range, served by the fallback mode
+          TableFallback,
+          /// NaN or infinity returned by a coefficient
+          NonFinite,
+          /// Hyperdual pow(x, a): |x| below the tolerance, clamped for the derivatives
+          PowClamp,
+          COUNT
+     };
+
+     inline const char *counter_name(Counter c)
+     {
+          switch (c)
+          {
+          case Counter::SeriesTaken: return "series: series branch";
+          case Counter::SeriesDirectTaken: return "series: direct branch";
+          case Counter::MixedSeriesTaken: return "mixed: series branch";
+          case Counter::MixedDirectTaken: return "mixed: direct branch";
+          case Counter::HalfAngleSeriesTaken: return "half-angle: series branch";
+          case Counter::HalfAngleDirectTaken: return "half-angle: direct branch";
+          case Counter::AdaptiveSeriesTaken: return "adaptive: series branch";
+          case Counter::AdaptiveDirectTaken: return "adaptive: direct branch";
+          case Counter::AdaptiveSeriesTerms: return "adaptive: series terms";
+          case Counter::HyperDualSeriesTaken: return "hyperdual-series: series branch";
+          case Counter::HyperDualDirectTaken: return "hyperdual-series: direct branch";
+          case Counter::TableFallback: return "table: fallback";
+          case Counter::NonFinite: return "non-finite results";
+          case Counter::PowClamp: return "hyperdual pow: tolerance clamp";
+          case Counter::COUNT: break;
+          }
+          return "unknown";
+     }
+
+     /**
+      * @brief Values of all the counters
+      */
+     struct CounterValues
+     {
+          static const std::size_t N = static_cast<std::size_t>(Counter::COUNT);
+
+          std::uint64_t values[N] = {};
+
+          std::uint64_t operator[](Counter c) const {
+               return values[static_cast<std::size_t>(c)];
+          }
+
+          void merge(const CounterValues &o) {
+               for (std::size_t i = 0; i < N; ++i) values[i] += o.values[i];
+          }
+
+          void report(std::ostream &out) const {
+               for (std::size_t i = 0; i < N; ++i)
+               {
+                    out << counter_name(static_cast<Counter>(i)) << ": " << values[i] << "\n";
+               }
+          }
+     };
+
+#ifdef RODRIGUES_INSTRUMENTATION
+
+     class Instrumentation
+     {
+     public:
+          static void count(Counter c, std::uint64_t n = 1) {
+               Counters::add(static_cast<std::size_t>(c), n);
+          }
+
+          /**
+           * @brief Counters of the calling thread
+           */
+          static CounterValues thread_values() {
+               return values(Counters::thread_values());
+          }
+
+          /**
+           * @brief Counters summed over every thread
+           */
+          static CounterValues total() {
+               return values(Counters::total());
+          }
+
+          static void report(std::ostream &out) {
+               out << "Instrumentation counters\n";
+               total().report(out);
+          }
+
+     protected:
+          typedef ThreadCounters<CounterValues::N, Instrumentation> Counters;
+
+          static CounterValues values(const Counters::Values &c) {
+               CounterValues v;
+               for (std::size_t i = 0; i < CounterValues::N; ++i) v.values[i] = c[i];
+               return v;
+          }
+     };
+
+     namespace detail
+     {
+          template < typename T > void count_non_finite(const T &v)
+          {
+               using std::isfinite;
+               if (!isfinite(v)) Instrumentation::count(Counter::NonFinite);
+          }
+     }
+
+#define RODRIGUES_COUNT(counter) ::rodrigues_formula::Instrumentation::count(::rodrigues_formula::Counter::counter)
+#define RODRIGUES_COUNT_N(counter, n) ::rodrigues_formula::Instrumentation::count(::rodrigues_formula::Counter::counter, n)
+#define RODRIGUES_COUNT_NON_FINITE(value) ::rodrigues_formula::detail::count_non_finite(value)
+
+#else
+
+#define RODRIGUES_COUNT(counter) ((void)0)
+#define RODRIGUES_COUNT_N(counter, n) ((void)0)
+#define RODRIGUES_COUNT_NON_FINITE(value) ((void)0)
+
+#endif
+
+}
+
+#endif
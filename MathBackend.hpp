@@ -0,0 +1,486 @@
+#ifndef _math_backend_h
+#define _math_backend_h
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "Float128.hpp"
+#include "Hyperdual.hpp"
+#include "SecondOrderDual.hpp"
+
+#ifdef RODRIGUES_HAVE_LIBMVEC
+#include <immintrin.h>
+
+// glibc vector math library, x86_64 vector ABI: b = SSE2, d = AVX2
+extern "C"
+{
+     __m128d _ZGVbN2v_sin(__m128d x);
+     __m128d _ZGVbN2v_cos(__m128d x);
+     __m128 _ZGVbN4v_sinf(__m128 x);
+     __m128 _ZGVbN4v_cosf(__m128 x);
+#ifdef __AVX2__
+     __m256d _ZGVdN4v_sin(__m256d x);
+     __m256d _ZGVdN4v_cos(__m256d x);
+     __m256 _ZGVdN8v_sinf(__m256 x);
+     __m256 _ZGVdN8v_cosf(__m256 x);
+#endif
+}
+#endif
+
+namespace rodrigues_formula
+{
+
+     /**
+      * @brief Transcendental function backends, selected by the Math type of the calculation
+      * policy (see DefaultPolicy).
+      *
+      * A backend provides sin(x), cos(x) and sincos(x, s, c) for every type the calculation modes
+      * use (float, double, long double, the wide types, and Hyperdual and SecondOrderDual of them), and a batch
+      * sincos(x, s, c, n) over arrays. A backend that only specialises some real types forwards
+      * the other ones to the libm overloads, and lifts its real sincos to the dual arguments.
+      *
+      * StdMath: the scalar libm, as found by unqualified calls (<cmath>, DoubleDouble.hpp,
+      *          Float128.hpp, Hyperdual.hpp).
+      * VectorMath: libm for scalars, glibc's libmvec for float and double batches when CMake
+      *             finds it (RODRIGUES_HAVE_LIBMVEC), with the AVX2 variants if the target has
+      *             AVX2.
+      * PolynomialMath: in-house float and double sincos, see below.
+      * BoundedPiMath: in-house float and double sincos for |x| <= pi, scalar and SIMD, see below.
+      */
+     namespace detail
+     {
+          template < class X > X libm_sin(const X &x)
+          {
+               return sin(x);
+          }
+
+          template < class X > X libm_cos(const X &x)
+          {
+               return cos(x);
+          }
+
+          /// fdlibm __kernel_sin, |x| <= pi/4. V is double or a vector of doubles.
+          template < typename V > V kernel_sin(V x)
+          {
+               const V z = x * x;
+               const V r = 8.33333333332248946124e-03 + z * (-1.98412698298579493134e-04 + z * (2.75573137070700676789e-06 +
+                           z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10)));
+               return x + x * z * (-1.66666666666666324348e-01 + z * r);
+          }
+
+          /// fdlibm __kernel_cos, |x| <= pi/4
+          template < typename V > V kernel_cos(V x)
+          {
+               const V z = x * x;
+               const V w = z * z;
+               const V r = z * (4.16666666666666019037e-02 + z * (-1.38888888888741095749e-03 + z * 2.48015872894767294178e-05)) +
+                           w * w * (-2.75573143513906633035e-07 + z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11));
+               const V hz = 0.5 * z;
+               const V v = 1.0 - hz;
+               return v + (((1.0 - v) - hz) + z * r);
+          }
+
+          /// fdlibm __kernel_sin(x, y, 1): sin(x + y) for |x| <= pi/4 and the reduction tail |y| << |x|
+          inline double kernel_sin(double x, double y)
+          {
+               const double z = x * x;
+               const double v = z * x;
+               const double r = 8.33333333332248946124e-03 + z * (-1.98412698298579493134e-04 + z * (2.75573137070700676789e-06 +
+                                z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10)));
+               return x - ((z * (0.5 * y - v * r) - y) - v * -1.66666666666666324348e-01);
+          }
+
+          /// fdlibm __kernel_cos(x, y): cos(x + y) for |x| <= pi/4 and the reduction tail |y| << |x|
+          inline double kernel_cos(double x, double y)
+          {
+               const double z = x * x;
+               const double w = z * z;
+               const double r = z * (4.16666666666666019037e-02 + z * (-1.38888888888741095749e-03 + z * 2.48015872894767294178e-05)) +
+                                w * w * (-2.75573143513906633035e-07 + z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11));
+               const double hz = 0.5 * z;
+               const double v = 1.0 - hz;
+               return v + (((1.0 - v) - hz) + (z * r - x * y));
+          }
+
+          /// FreeBSD __kernel_sindf, |x| <= pi/4, accurate to float precision when evaluated in double
+          inline double kernel_sindf(double x)
+          {
+               const double z = x * x;
+               return x + x * z * (-0.166666666416265235595 + z * (0.0083333293858894631756 +
+                                   z * (-0.000198393348360966317347 + z * 0.0000027183114939898219064)));
+          }
+
+          /// FreeBSD __kernel_cosdf, |x| <= pi/4
+          inline double kernel_cosdf(double x)
+          {
+               const double z = x * x;
+               return 1.0 + z * (-0.499999997251031003120 + z * (0.0416666233237390631894 +
+                                 z * (-0.00138867637746099294692 + z * 0.0000243904487962774090654)));
+          }
+
+          /// Cephes sinf kernel, |x| <= pi/4, evaluated in float. V is float or a vector of floats.
+          template < typename V > V kernel_sinf(V x)
+          {
+               const V z = x * x;
+               return ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * x + x;
+          }
+
+          /// Cephes cosf kernel, |x| <= pi/4, evaluated in float
+          template < typename V > V kernel_cosf(V x)
+          {
+               const V z = x * x;
+               return ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z - 0.5f * z + 1.0f;
+          }
+
+          typedef double Vec4d __attribute__((vector_size(32)));
+          typedef std::int64_t Vec4l __attribute__((vector_size(32)));
+          typedef float Vec8f __attribute__((vector_size(32)));
+          typedef std::int32_t Vec8i __attribute__((vector_size(32)));
+
+          inline std::int64_t bits_of(double x) { std::int64_t i; std::memcpy(&i, &x, sizeof(i)); return i; }
+          inline std::int32_t bits_of(float x) { std::int32_t i; std::memcpy(&i, &x, sizeof(i)); return i; }
+          inline Vec4l bits_of(Vec4d x) { Vec4l i; std::memcpy(&i, &x, sizeof(i)); return i; }
+          inline Vec8i bits_of(Vec8f x) { Vec8i i; std::memcpy(&i, &x, sizeof(i)); return i; }
+
+          /**
+           * @brief sin and cos for |x| <= pi, branch-free so that V can be a GCC vector type: the
+           * quadrant k = round(2x / pi) in [-2, 2] is taken from the bits of 2x / pi + 1.5 2^52,
+           * and the products k (pi/2)_i of the 3-part Cody-Waite reduction are exact.
+           */
+          template < typename V > void bounded_sincos(V x, V &s, V &c)
+          {
+               const double ROUND = 6755399441055744.0;
+               const V kk = x * 6.36619772367581382433e-01 + ROUND;
+               const auto q = bits_of(kk);
+               const V k = kk - ROUND;
+               const V r = ((x - k * 1.57079632673412561417e+00) - k * 6.07710050630396597660e-11) - k * 2.02226624871116645580e-21;
+               const V sr = kernel_sin(r), cr = kernel_cos(r);
+               const V s1 = (q & 1) ? cr : sr;
+               const V c1 = (q & 1) ? sr : cr;
+               s = (q & 2) ? -s1 : s1;
+               c = ((q + 1) & 2) ? -c1 : c1;
+          }
+
+          /// Same in float, with the pi/2 split in 8, 11 and 24 significant bits
+          template < typename V > void bounded_sincosf(V x, V &s, V &c)
+          {
+               const float ROUND = 12582912.0f;
+               const V kk = x * 0.636619772f + ROUND;
+               const auto q = bits_of(kk);
+               const V k = kk - ROUND;
+               const V r = ((x - k * 1.5703125f) - k * 4.837512969970703125e-4f) - k * 7.54978995489188216e-8f;
+               const V sr = kernel_sinf(r), cr = kernel_cosf(r);
+               const V s1 = (q & 1) ? cr : sr;
+               const V c1 = (q & 1) ? sr : cr;
+               s = (q & 2) ? -s1 : s1;
+               c = ((q + 1) & 2) ? -c1 : c1;
+          }
+
+          /// sin and cos of a hyper-dual number from the sin and cos of its real part
+          template < class Math, typename R > void hyperdual_sincos(Hyperdual<R> x, Hyperdual<R> &s, Hyperdual<R> &c)
+          {
+               R sr, cr;
+               Math::sincos(x.real(), sr, cr);
+               const R f1 = x.eps1(), f2 = x.eps2(), f12 = x.eps1eps2();
+               s = Hyperdual<R>(sr, cr * f1, cr * f2, cr * f12 - sr * f1 * f2);
+               c = Hyperdual<R>(cr, -sr * f1, -sr * f2, -sr * f12 - cr * f1 * f2);
+          }
+
+          template < class Math, typename R > void dual_sincos(SecondOrderDual<R> x, SecondOrderDual<R> &s, SecondOrderDual<R> &c)
+          {
+               R sr, cr;
+               Math::sincos(x.real(), sr, cr);
+               const R f1 = x.eps1(), f12 = x.eps1eps2();
+               s = SecondOrderDual<R>(sr, cr * f1, cr * f12 - sr * f1 * f1);
+               c = SecondOrderDual<R>(cr, -sr * f1, -sr * f12 - cr * f1 * f1);
+          }
+     }
+
+     struct StdMath
+     {
+          static const char *name() { return "std"; }
+
+          template < class X > static X sin(const X &x) {
+               return detail::libm_sin(x);
+          }
+
+          template < class X > static X cos(const X &x) {
+               return detail::libm_cos(x);
+          }
+
+          template < class X > static void sincos(const X &x, X &s, X &c) {
+               s = detail::libm_sin(x);
+               c = detail::libm_cos(x);
+          }
+
+          template < typename T > static void sincos(const T *x, T *s, T *c, std::size_t n) {
+               for (std::size_t i = 0; i < n; ++i) s[i] = detail::libm_sin(x[i]);
+               for (std::size_t i = 0; i < n; ++i) c[i] = detail::libm_cos(x[i]);
+          }
+     };
+
+     struct VectorMath : StdMath
+     {
+          static const char *name() { return "libmvec"; }
+
+          using StdMath::sincos;
+
+#ifdef RODRIGUES_HAVE_LIBMVEC
+          static void sincos(const double *x, double *s, double *c, std::size_t n) {
+               std::size_t i = 0;
+#ifdef __AVX2__
+               for (; i + 4 <= n; i += 4)
+               {
+                    const __m256d v = _mm256_loadu_pd(x + i);
+                    _mm256_storeu_pd(s + i, _ZGVdN4v_sin(v));
+                    _mm256_storeu_pd(c + i, _ZGVdN4v_cos(v));
+               }
+#endif
+               for (; i + 2 <= n; i += 2)
+               {
+                    const __m128d v = _mm_loadu_pd(x + i);
+                    _mm_storeu_pd(s + i, _ZGVbN2v_sin(v));
+                    _mm_storeu_pd(c + i, _ZGVbN2v_cos(v));
+               }
+               StdMath::sincos(x + i, s + i, c + i, n - i);
+          }
+
+          static void sincos(const float *x, float *s, float *c, std::size_t n) {
+               std::size_t i = 0;
+#ifdef __AVX2__
+               for (; i + 8 <= n; i += 8)
+               {
+                    const __m256 v = _mm256_loadu_ps(x + i);
+                    _mm256_storeu_ps(s + i, _ZGVdN8v_sinf(v));
+                    _mm256_storeu_ps(c + i, _ZGVdN8v_cosf(v));
+               }
+#endif
+               for (; i + 4 <= n; i += 4)
+               {
+                    const __m128 v = _mm_loadu_ps(x + i);
+                    _mm_storeu_ps(s + i, _ZGVbN4v_sinf(v));
+                    _mm_storeu_ps(c + i, _ZGVbN4v_cosf(v));
+               }
+               StdMath::sincos(x + i, s + i, c + i, n - i);
+          }
+#endif
+     };
+
+     /**
+      * @brief In-house float and double sin / cos: argument reduction by multiples of pi/2
+      * (Cody-Waite, pi/2 split in parts whose products with the quadrant are exact) and the
+      * fdlibm minimax polynomials on [-pi/4, pi/4], double ones for double and the shorter
+      * FreeBSD float kernels evaluated in double for float. In double the reduced argument is kept
+      * as a head and a tail, which the kernels take as fdlibm's do. Measured errors, for
+      * |x| < 4000, are below 0.8 ulp in double and 0.51 ulp in float.
+      *
+      * The reduction is only accurate for |x| < 2^19 pi/2, beyond which the functions fall back
+      * to libm. sin and cos come from a single reduction, so sincos() costs little more than sin().
+      */
+     struct PolynomialMath : StdMath
+     {
+          static const char *name() { return "poly"; }
+
+          using StdMath::sin;
+          using StdMath::cos;
+          using StdMath::sincos;
+
+          static void sincos(double x, double &s, double &c) {
+               if (!(std::fabs(x) < REDUCTION_LIMIT))
+               {
+                    StdMath::sincos(x, s, c);
+                    return;
+               }
+               const double k = std::nearbyint(x * TWO_OVER_PI);
+               // x - k pi/2 = r + y: the first two steps are exact up to the rounding error e of
+               // the second subtraction, which is folded into the third one
+               const double t = x - k * PIO2_1;
+               const double w = k * PIO2_2;
+               const double r2 = t - w;
+               const double w3 = k * PIO2_3 - ((t - r2) - w);
+               const double r = r2 - w3;
+               const double y = (r2 - r) - w3;
+               quadrant(static_cast<long>(k), detail::kernel_sin(r, y), detail::kernel_cos(r, y), s, c);
+          }
+
+          static void sincos(float x, float &s, float &c) {
+               const double xd = x;
+               if (!(std::fabs(xd) < REDUCTION_LIMIT))
+               {
+                    StdMath::sincos(x, s, c);
+                    return;
+               }
+               const double k = std::nearbyint(xd * TWO_OVER_PI);
+               const double r = (xd - k * PIO2_1) - k * PIO2_1T;
+               double sd, cd;
+               quadrant(static_cast<long>(k), detail::kernel_sindf(r), detail::kernel_cosdf(r), sd, cd);
+               s = static_cast<float>(sd);
+               c = static_cast<float>(cd);
+          }
+
+          template < typename R > static void sincos(const Hyperdual<R> &x, Hyperdual<R> &s, Hyperdual<R> &c) {
+               detail::hyperdual_sincos<PolynomialMath>(x, s, c);
+          }
+
+          template < typename R > static void sincos(const SecondOrderDual<R> &x, SecondOrderDual<R> &s, SecondOrderDual<R> &c) {
+               detail::dual_sincos<PolynomialMath>(x, s, c);
+          }
+
+          static double sin(double x) { double s, c; sincos(x, s, c); return s; }
+          static double cos(double x) { double s, c; sincos(x, s, c); return c; }
+          static float sin(float x) { float s, c; sincos(x, s, c); return s; }
+          static float cos(float x) { float s, c; sincos(x, s, c); return c; }
+
+          template < typename R > static Hyperdual<R> sin(const Hyperdual<R> &x) {
+               Hyperdual<R> s, c;
+               sincos(x, s, c);
+               return s;
+          }
+
+          template < typename R > static Hyperdual<R> cos(const Hyperdual<R> &x) {
+               Hyperdual<R> s, c;
+               sincos(x, s, c);
+               return c;
+          }
+
+          template < typename R > static SecondOrderDual<R> sin(const SecondOrderDual<R> &x) {
+               SecondOrderDual<R> s, c;
+               sincos(x, s, c);
+               return s;
+          }
+
+          template < typename R > static SecondOrderDual<R> cos(const SecondOrderDual<R> &x) {
+               SecondOrderDual<R> s, c;
+               sincos(x, s, c);
+               return c;
+          }
+
+          static void sincos(const double *x, double *s, double *c, std::size_t n) {
+               for (std::size_t i = 0; i < n; ++i) sincos(x[i], s[i], c[i]);
+          }
+
+          static void sincos(const float *x, float *s, float *c, std::size_t n) {
+               for (std::size_t i = 0; i < n; ++i) sincos(x[i], s[i], c[i]);
+          }
+
+     protected:
+          static constexpr double TWO_OVER_PI = 6.36619772367581382433e-01;
+          /// pi/2 = PIO2_1 + PIO2_2 + PIO2_3 + O(2^-150), the first two with 33 significant bits
+          static constexpr double PIO2_1 = 1.57079632673412561417e+00;
+          static constexpr double PIO2_2 = 6.07710050630396597660e-11;
+          static constexpr double PIO2_3 = 2.02226624871116645580e-21;
+          /// pi/2 - PIO2_1
+          static constexpr double PIO2_1T = 6.07710050650619224932e-11;
+          /// 2^19 pi/2: k PIO2_1 and k PIO2_2 are exact for |k| <= 2^20
+          static constexpr double REDUCTION_LIMIT = 823549.0;
+
+          static void quadrant(long k, double sr, double cr, double &s, double &c) {
+               switch (k & 3)
+               {
+               case 0: s = sr; c = cr; break;
+               case 1: s = cr; c = -sr; break;
+               case 2: s = -sr; c = -cr; break;
+               default: s = -cr; c = sr; break;
+               }
+          }
+     };
+
+     /**
+      * @brief float and double sin / cos for angles known to satisfy |x| <= pi, e.g. rotation
+      * vector magnitudes: no large argument reduction, no fallback, no branch. The quadrant
+      * reduction is a handful of exact operations, the polynomials are those of PolynomialMath
+      * (fdlibm) for double and the Cephes float ones, evaluated in float, for float. The batch
+      * sincos runs the same code on GCC vectors of 4 doubles or 8 floats.
+      *
+      * Error bounds for |x| <= pi: 1.5 ulp for float (exhaustive) and 1.5 ulp for double (10^7
+      * random arguments, against long double). Results are exactly odd / even in x. Larger
+      * arguments are a precondition violation (asserted up to |x| <= 4 for the rounding of pi);
+      * other types fall back to libm.
+      */
+     struct BoundedPiMath : StdMath
+     {
+          static const char *name() { return "bounded-pi"; }
+
+          using StdMath::sin;
+          using StdMath::cos;
+          using StdMath::sincos;
+
+          static void sincos(double x, double &s, double &c) {
+               assert(std::fabs(x) <= 4);
+               detail::bounded_sincos(x, s, c);
+          }
+
+          static void sincos(float x, float &s, float &c) {
+               assert(std::fabs(x) <= 4);
+               detail::bounded_sincosf(x, s, c);
+          }
+
+          template < typename R > static void sincos(const Hyperdual<R> &x, Hyperdual<R> &s, Hyperdual<R> &c) {
+               detail::hyperdual_sincos<BoundedPiMath>(x, s, c);
+          }
+
+          template < typename R > static void sincos(const SecondOrderDual<R> &x, SecondOrderDual<R> &s, SecondOrderDual<R> &c) {
+               detail::dual_sincos<BoundedPiMath>(x, s, c);
+          }
+
+          static double sin(double x) { double s, c; sincos(x, s, c); return s; }
+          static double cos(double x) { double s, c; sincos(x, s, c); return c; }
+          static float sin(float x) { float s, c; sincos(x, s, c); return s; }
+          static float cos(float x) { float s, c; sincos(x, s, c); return c; }
+
+          template < typename R > static Hyperdual<R> sin(const Hyperdual<R> &x) {
+               Hyperdual<R> s, c;
+               sincos(x, s, c);
+               return s;
+          }
+
+          template < typename R > static Hyperdual<R> cos(const Hyperdual<R> &x) {
+               Hyperdual<R> s, c;
+               sincos(x, s, c);
+               return c;
+          }
+
+          template < typename R > static SecondOrderDual<R> sin(const SecondOrderDual<R> &x) {
+               SecondOrderDual<R> s, c;
+               sincos(x, s, c);
+               return s;
+          }
+
+          template < typename R > static SecondOrderDual<R> cos(const SecondOrderDual<R> &x) {
+               SecondOrderDual<R> s, c;
+               sincos(x, s, c);
+               return c;
+          }
+
+          static void sincos(const double *x, double *s, double *c, std::size_t n) {
+               batch<detail::Vec4d>(x, s, c, n);
+          }
+
+          static void sincos(const float *x, float *s, float *c, std::size_t n) {
+               batch<detail::Vec8f>(x, s, c, n);
+          }
+
+     protected:
+          template < typename V, typename T > static void batch(const T *x, T *s, T *c, std::size_t n) {
+               const std::size_t LANES = sizeof(V) / sizeof(T);
+               std::size_t i = 0;
+               for (; i + LANES <= n; i += LANES)
+               {
+                    V v, vs, vc;
+                    std::memcpy(&v, x + i, sizeof(v));
+                    sincos_lanes(v, vs, vc);
+                    std::memcpy(s + i, &vs, sizeof(vs));
+                    std::memcpy(c + i, &vc, sizeof(vc));
+               }
+               for (; i < n; ++i) sincos(x[i], s[i], c[i]);
+          }
+
+          static void sincos_lanes(detail::Vec4d x, detail::Vec4d &s, detail::Vec4d &c) { detail::bounded_sincos(x, s, c); }
+          static void sincos_lanes(detail::Vec8f x, detail::Vec8f &s, detail::Vec8f &c) { detail::bounded_sincosf(x, s, c); }
+     };
+
+}
+
+#endif
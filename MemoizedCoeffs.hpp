@@ -0,0 +1,186 @@
+#ifndef _memoized_coeffs_h
+#define _memoized_coeffs_h
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <ostream>
+#include <vector>
+#include "ThreadCounters.hpp"
+
+namespace rodrigues_formula
+{
+
+     /**
+      * @brief Hit / miss counters of a memoization cache
+      */
+     struct MemoStats
+     {
+          std::uint64_t hits = 0;
+          std::uint64_t misses = 0;
+          std::uint64_t evictions = 0;
+
+          double hit_rate() const {
+               const std::uint64_t n = hits + misses;
+               return n ? static_cast<double>(hits) / n : 0.;
+          }
+
+          void merge(const MemoStats &o) {
+               hits += o.hits;
+               misses += o.misses;
+               evictions += o.evictions;
+          }
+
+          void report(std::ostream &out) const {
+               out << hits << " hits, " << misses << " misses (hit rate " << hit_rate()
+                   << "), " << evictions << " evictions\n";
+          }
+     };
+
+     /**
+      * @brief Memoizing front-end to a TrigonometricCoeffs class.
+      *
+      * Iterative solvers (e.g. Newton iterations on rotation fields) keep asking for the
+      * coefficients of the same angles: get() returns the whole CoefficientBundle of theta, computed
+      * by TCs::bundle() on the first request and served from a cache afterwards. The cache is keyed
+      * on the exact bit pattern of theta, so it never changes a result; non-finite angles are not
+      * cached.
+      *
+      * Each thread owns its cache, hence no synchronisation on lookup. A cache is a fixed array of
+      * 2^LOG2_SLOTS entries, each one aligned to a cache line, with open addressing: theta is
+      * hashed (Fibonacci hashing) to a slot and the next PROBE - 1 slots are probed. On a miss with
+      * no free slot in the window one of them is evicted in round-robin order, so the memory per
+      * thread is bounded and a lookup touches at most PROBE cache lines.
+      *
+      * Per-thread hit, miss and eviction counts (ThreadCounters.hpp) are available through
+      * thread_stats(), and the sum over all threads (alive or already finished) through
+      * total_stats().
+      */
+     template < class TCs, unsigned LOG2_SLOTS = 10 > class MemoizedCoeffs
+     {
+     public:
+          typedef typename TCs::RealType RealType;
+          typedef typename TCs::Bundle Bundle;
+
+          static const unsigned SLOTS = 1u << LOG2_SLOTS;
+          static const unsigned PROBE = 4;
+
+          static_assert(LOG2_SLOTS > 0 && LOG2_SLOTS < 32, "Unsupported cache size");
+          static_assert(sizeof(RealType) <= sizeof(std::uint64_t), "Keys wider than 64 bits are not supported");
+
+          static Bundle get(RealType theta) {
+               if (!std::isfinite(theta)) return TCs::bundle(theta);
+               return cache().get(theta);
+          }
+
+          /**
+           * @brief Counters of the calling thread's cache
+           */
+          static MemoStats thread_stats() {
+               return stats(Counters::thread_values());
+          }
+
+          /**
+           * @brief Counters summed over every thread that used the cache
+           */
+          static MemoStats total_stats() {
+               return stats(Counters::total());
+          }
+
+          /**
+           * @brief Empties the calling thread's cache. Counters are kept.
+           */
+          static void clear() {
+               cache().clear();
+          }
+
+     protected:
+          static const std::uint64_t EMPTY = ~std::uint64_t(0);
+
+          struct alignas(64) Entry
+          {
+               std::uint64_t key;
+               Bundle value;
+          };
+
+          enum { HITS, MISSES, EVICTIONS, N_COUNTERS };
+          typedef ThreadCounters<N_COUNTERS, MemoizedCoeffs> Counters;
+
+          static MemoStats stats(const typename Counters::Values &c) {
+               MemoStats s;
+               s.hits = c[HITS];
+               s.misses = c[MISSES];
+               s.evictions = c[EVICTIONS];
+               return s;
+          }
+
+          class Cache
+          {
+          public:
+               Cache() : m_storage(SLOTS * sizeof(Entry) + alignof(Entry)), m_victim(0) {
+                    // std::allocator does not honour extended alignments before C++17
+                    const std::uintptr_t p = reinterpret_cast<std::uintptr_t>(m_storage.data());
+                    m_entries = reinterpret_cast<Entry *>((p + alignof(Entry) - 1) & ~std::uintptr_t(alignof(Entry) - 1));
+                    for (unsigned i = 0; i < SLOTS; ++i) new (m_entries + i) Entry();
+                    clear();
+               }
+
+               ~Cache() {
+                    for (unsigned i = 0; i < SLOTS; ++i) m_entries[i].~Entry();
+               }
+
+               Bundle get(RealType theta) {
+                    const std::uint64_t key = bits(theta);
+                    const unsigned home = static_cast<unsigned>((key * 0x9E3779B97F4A7C15ull) >> (64 - LOG2_SLOTS));
+                    for (unsigned p = 0; p < PROBE; ++p)
+                    {
+                         Entry &e = m_entries[(home + p) & (SLOTS - 1)];
+                         if (e.key == key)
+                         {
+                              Counters::add(HITS);
+                              return e.value;
+                         }
+                         if (e.key == EMPTY)
+                         {
+                              Counters::add(MISSES);
+                              e.value = TCs::bundle(theta);
+                              e.key = key;
+                              return e.value;
+                         }
+                    }
+                    Counters::add(MISSES);
+                    Counters::add(EVICTIONS);
+                    Entry &e = m_entries[(home + m_victim) & (SLOTS - 1)];
+                    m_victim = (m_victim + 1) % PROBE;
+                    e.value = TCs::bundle(theta);
+                    e.key = key;
+                    return e.value;
+               }
+
+               void clear() {
+                    for (unsigned i = 0; i < SLOTS; ++i) m_entries[i].key = EMPTY;
+               }
+
+          protected:
+               std::vector<char> m_storage;
+               Entry *m_entries;
+               unsigned m_victim;
+
+               /// No finite value has the EMPTY bit pattern, as it is a NaN for every supported type
+               static std::uint64_t bits(RealType theta) {
+                    std::uint64_t k = 0;
+                    std::memcpy(&k, &theta, sizeof(theta));
+                    return k;
+               }
+          };
+
+          static Cache &cache() {
+               static thread_local Cache c;
+               return c;
+          }
+     };
+
+}
+
+#endif
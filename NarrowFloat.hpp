@@ -0,0 +1,171 @@
+#ifndef _narrow_float_h
+#define _narrow_float_h
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+#include "ColumnarWriter.hpp"
+
+namespace rodrigues_formula
+{
+
+     namespace detail
+     {
+          inline std::uint32_t float_bits(float x)
+          {
+               std::uint32_t u;
+               std::memcpy(&u, &x, sizeof(u));
+               return u;
+          }
+
+          inline float bits_float(std::uint32_t u)
+          {
+               float x;
+               std::memcpy(&x, &u, sizeof(x));
+               return x;
+          }
+     }
+
+     /**
+      * @brief 16-bit storage formats for the results, computed in float and rounded (to nearest,
+      * ties to even) when stored. They only hold the bit pattern: values are converted in batches
+      * with narrow() and widen(), whose loops are branch-free so that the compiler vectorizes them.
+      * When the target has F16C, Half uses its conversion instructions, 8 values at a time.
+      *
+      * Each format also describes its precision (DIGITS, MIN_EXPONENT of the smallest normal
+      * number and max()), so that accuracy can be measured in its own ULPs.
+      */
+
+     /**
+      * @brief IEEE 754 binary16 (_Float16): 11 significant bits, range 6.1e-5 .. 65504
+      */
+     struct Half
+     {
+          std::uint16_t bits;
+
+          static const int DIGITS = 11;
+          static const int MIN_EXPONENT = -14;
+          static float max() { return 65504.f; }
+          static const char *name() { return "half"; }
+
+          static std::uint16_t from_float(float x) {
+               // F. Giesen's float_to_half_fast3_rtne, with selects instead of branches
+               const std::uint32_t F32_INFTY = 255u << 23;
+               const std::uint32_t F16_MAX = (127u + 16) << 23;
+               const std::uint32_t DENORM_MAGIC = ((127u - 15) + (23 - 10) + 1) << 23;
+               std::uint32_t f = detail::float_bits(x);
+               const std::uint32_t sign = f & 0x80000000u;
+               f ^= sign;
+
+               const std::uint32_t overflow = f > F32_INFTY ? 0x7e00u : 0x7c00u;
+               const std::uint32_t denormal = detail::float_bits(detail::bits_float(f) + detail::bits_float(DENORM_MAGIC)) - DENORM_MAGIC;
+               const std::uint32_t mant_odd = (f >> 13) & 1;
+               const std::uint32_t normal = (f + (static_cast<std::uint32_t>(15 - 127) << 23) + 0xfffu + mant_odd) >> 13;
+
+               const std::uint32_t o = f >= F16_MAX ? overflow : (f < (113u << 23) ? denormal : normal);
+               return static_cast<std::uint16_t>(o | (sign >> 16));
+          }
+
+          static float to_float(std::uint16_t h) {
+               const std::uint32_t SHIFTED_EXP = 0x7c00u << 13;
+               const float MAGIC = detail::bits_float(113u << 23);
+               std::uint32_t o = (h & 0x7fffu) << 13;
+               const std::uint32_t exp = SHIFTED_EXP & o;
+               o += (127u - 15) << 23;
+               const std::uint32_t inf_nan = o + ((128u - 16) << 23);
+               const std::uint32_t denormal = detail::float_bits(detail::bits_float(o + (1u << 23)) - MAGIC);
+               o = exp == SHIFTED_EXP ? inf_nan : (exp == 0 ? denormal : o);
+               return detail::bits_float(o | (static_cast<std::uint32_t>(h & 0x8000u) << 16));
+          }
+
+          static void narrow(const float *in, Half *out, std::size_t n) {
+               std::size_t i = 0;
+#ifdef __F16C__
+               for (; i + 8 <= n; i += 8)
+               {
+                    const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), h);
+               }
+#endif
+               for (; i < n; ++i) out[i].bits = from_float(in[i]);
+          }
+
+          static void widen(const Half *in, float *out, std::size_t n) {
+               std::size_t i = 0;
+#ifdef __F16C__
+               for (; i + 8 <= n; i += 8)
+               {
+                    const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+                    _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+               }
+#endif
+               for (; i < n; ++i) out[i] = to_float(in[i].bits);
+          }
+     };
+
+     /**
+      * @brief bfloat16, the upper half of a float: 8 significant bits, float range
+      */
+     struct BFloat16
+     {
+          std::uint16_t bits;
+
+          static const int DIGITS = 8;
+          static const int MIN_EXPONENT = -126;
+          static float max() { return detail::bits_float(0x7f7f0000u); }
+          static const char *name() { return "bfloat16"; }
+
+          static std::uint16_t from_float(float x) {
+               const std::uint32_t u = detail::float_bits(x);
+               const std::uint32_t rounded = (u + 0x7fffu + ((u >> 16) & 1)) >> 16;
+               // NaNs are kept quiet instead of being rounded into infinities
+               const bool nan = (u & 0x7fffffffu) > 0x7f800000u;
+               return static_cast<std::uint16_t>(nan ? (u >> 16) | 0x40u : rounded);
+          }
+
+          static float to_float(std::uint16_t b) {
+               return detail::bits_float(static_cast<std::uint32_t>(b) << 16);
+          }
+
+          static void narrow(const float *in, BFloat16 *out, std::size_t n) {
+               for (std::size_t i = 0; i < n; ++i) out[i].bits = from_float(in[i]);
+          }
+
+          static void widen(const BFloat16 *in, float *out, std::size_t n) {
+               for (std::size_t i = 0; i < n; ++i) out[i] = to_float(in[i].bits);
+          }
+     };
+
+     /**
+      * @brief Rounds the values in place to the given storage format, i.e. widen(narrow(v))
+      */
+     template < class Narrow > void round_to(float *values, std::size_t n)
+     {
+          const std::size_t BLOCK = 256;
+          Narrow tmp[BLOCK];
+          for (std::size_t i = 0; i < n; i += BLOCK)
+          {
+               const std::size_t m = n - i < BLOCK ? n - i : BLOCK;
+               Narrow::narrow(values + i, tmp, m);
+               Narrow::widen(tmp, values + i, m);
+          }
+     }
+
+     template <> struct ColumnType<Half>
+     {
+          static std::string descr() { return std::string(1, detail::byte_order_char()) + "f2"; }
+     };
+
+     /// Not a numpy builtin: the type registered by the ml_dtypes package, e.g. for JAX
+     template <> struct ColumnType<BFloat16>
+     {
+          static std::string descr() { return "bfloat16"; }
+     };
+
+}
+
+#endif
@@ -0,0 +1,239 @@
+#ifndef _result_sink_h
+#define _result_sink_h
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ColumnarWriter.hpp"
+
+namespace rodrigues_formula
+{
+
+     /**
+      * @brief Destination of the evaluation results: one pre-sized column of n_rows values per
+      * (group, name) pair, e.g. ("direct", "a0").
+      *
+      * Columns are handed out as raw pointers so that the evaluation jobs can fill disjoint ranges
+      * of them concurrently.
+      */
+     template < typename T > class ResultSink
+     {
+     public:
+          explicit ResultSink(std::uint64_t n_rows) : m_n_rows(n_rows) { }
+          virtual ~ResultSink() { }
+
+          std::uint64_t rows() const {
+               return m_n_rows;
+          }
+
+          /**
+           * @brief Returns the storage for the given column, creating it on first request.
+           */
+          virtual T *column(const std::string &group, const std::string &name) = 0;
+
+     protected:
+          std::uint64_t m_n_rows;
+     };
+
+     /**
+      * @brief Sink keeping every column in memory
+      */
+     template < typename T > class MemoryResultSink : public ResultSink<T>
+     {
+     public:
+          typedef std::map<std::string, std::map<std::string, std::vector<T>>> Columns;
+
+          explicit MemoryResultSink(std::uint64_t n_rows) : ResultSink<T>(n_rows) { }
+
+          T *column(const std::string &group, const std::string &name) override {
+               std::vector<T> &c = m_columns[group][name];
+               c.resize(this->m_n_rows);
+               return c.data();
+          }
+
+          const Columns &columns() const {
+               return m_columns;
+          }
+
+     protected:
+          Columns m_columns;
+     };
+
+     /**
+      * @brief A single column stored in a memory-mapped file.
+      *
+      * The file is a one-column file in the ColumnarWriter format, so the same readers can load it.
+      * Created columns are pre-sized and mapped read-write: the values written through data() go
+      * straight to the page cache and the kernel writes them back as needed, so columns larger than
+      * the available RAM can be produced. Opened columns are mapped read-only, zero-copy.
+      */
+     template < typename T > class MappedColumn
+     {
+     public:
+          MappedColumn() { }
+
+          MappedColumn(MappedColumn &&other) :
+               m_map(other.m_map), m_map_size(other.m_map_size), m_data(other.m_data),
+               m_n_rows(other.m_n_rows), m_name(std::move(other.m_name)) {
+               other.m_map = nullptr;
+          }
+
+          MappedColumn &operator=(MappedColumn &&other) {
+               std::swap(m_map, other.m_map);
+               std::swap(m_map_size, other.m_map_size);
+               std::swap(m_data, other.m_data);
+               std::swap(m_n_rows, other.m_n_rows);
+               std::swap(m_name, other.m_name);
+               return *this;
+          }
+
+          MappedColumn(const MappedColumn &) = delete;
+          MappedColumn &operator=(const MappedColumn &) = delete;
+
+          ~MappedColumn() {
+               if (m_map) ::munmap(m_map, m_map_size);
+          }
+
+          /**
+           * @brief Creates (or truncates) path as a column of n_rows elements and maps it read-write
+           */
+          static MappedColumn create(const std::string &path, const std::string &name, std::uint64_t n_rows) {
+               ColumnarWriter layout;
+               layout.add_column(name, static_cast<const T *>(nullptr), n_rows);
+               const std::vector<char> header = layout.header();
+               const std::uint64_t offset = layout.offset(0);
+
+               MappedColumn c;
+               c.m_map_size = offset + n_rows * sizeof(T);
+               c.m_n_rows = n_rows;
+               c.m_name = name;
+
+               const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+               if (fd < 0) throw std::system_error(errno, std::generic_category(), "cannot create " + path);
+               if (::ftruncate(fd, c.m_map_size) != 0)
+               {
+                    const int err = errno;
+                    ::close(fd);
+                    throw std::system_error(err, std::generic_category(), "cannot resize " + path);
+               }
+               c.map(fd, PROT_READ | PROT_WRITE, path);
+               std::memcpy(c.m_map, header.data(), header.size());
+               c.m_data = reinterpret_cast<T *>(static_cast<char *>(c.m_map) + offset);
+               // No access pattern hint: work stealing fills the chunks out of order across the mapping
+               return c;
+          }
+
+          /**
+           * @brief Maps an existing one-column file read-only
+           */
+          static MappedColumn open(const std::string &path) {
+               const int fd = ::open(path.c_str(), O_RDONLY);
+               if (fd < 0) throw std::system_error(errno, std::generic_category(), "cannot open " + path);
+               struct stat st;
+               if (::fstat(fd, &st) != 0)
+               {
+                    const int err = errno;
+                    ::close(fd);
+                    throw std::system_error(err, std::generic_category(), "cannot stat " + path);
+               }
+
+               MappedColumn c;
+               c.m_map_size = st.st_size;
+               c.map(fd, PROT_READ, path);
+
+               const char *base = static_cast<const char *>(c.m_map);
+               auto read_at = [&](std::uint64_t pos, void *dst, std::size_t n) {
+                    if (pos + n > c.m_map_size) throw std::runtime_error(path + ": truncated header");
+                    std::memcpy(dst, base + pos, n);
+               };
+               char magic[8], descr[9] = { 0 };
+               std::uint32_t version, n_columns, name_len;
+               std::uint64_t n_rows, offset, n_bytes;
+               read_at(0, magic, 8);
+               read_at(8, &version, 4);
+               read_at(12, &n_columns, 4);
+               read_at(16, &n_rows, 8);
+               if (std::memcmp(magic, "RCCOLUMN", 8) != 0 || version != ColumnarWriter::VERSION || n_columns != 1)
+               {
+                    throw std::runtime_error(path + ": not a single column file");
+               }
+               read_at(32, descr, 8);
+               read_at(40, &offset, 8);
+               read_at(48, &n_bytes, 8);
+               read_at(56, &name_len, 4);
+               if (ColumnType<T>::descr() != descr || n_bytes != n_rows * sizeof(T) || offset + n_bytes > c.m_map_size)
+               {
+                    throw std::runtime_error(path + ": unexpected column type or size");
+               }
+               c.m_name.resize(name_len);
+               read_at(60, &c.m_name[0], name_len);
+               c.m_n_rows = n_rows;
+               c.m_data = reinterpret_cast<T *>(static_cast<char *>(c.m_map) + offset);
+               return c;
+          }
+
+          T *data() { return m_data; }
+          const T *data() const { return m_data; }
+          std::uint64_t size() const { return m_n_rows; }
+          const std::string &name() const { return m_name; }
+
+     protected:
+          void *m_map = nullptr;
+          std::uint64_t m_map_size = 0;
+          T *m_data = nullptr;
+          std::uint64_t m_n_rows = 0;
+          std::string m_name;
+
+          void map(int fd, int prot, const std::string &path) {
+               void *p = ::mmap(nullptr, m_map_size, prot, MAP_SHARED, fd, 0);
+               const int err = errno;
+               ::close(fd);
+               if (p == MAP_FAILED) throw std::system_error(err, std::generic_category(), "cannot map " + path);
+               m_map = p;
+          }
+     };
+
+     /**
+      * @brief Sink streaming every column into its own memory-mapped file, named
+      * <directory>/<group>_<name>.rccol. The directory must exist.
+      */
+     template < typename T > class MappedResultStore : public ResultSink<T>
+     {
+     public:
+          MappedResultStore(const std::string &directory, std::uint64_t n_rows) :
+               ResultSink<T>(n_rows), m_directory(directory) { }
+
+          T *column(const std::string &group, const std::string &name) override {
+               const std::string key = group.empty() ? name : group + "_" + name;
+               auto it = m_columns.find(key);
+               if (it == m_columns.end())
+               {
+                    const std::string col_name = group.empty() ? name : group + "/" + name;
+                    it = m_columns.insert(std::make_pair(
+                              key, MappedColumn<T>::create(path(key), col_name, this->m_n_rows))).first;
+               }
+               return it->second.data();
+          }
+
+          std::string path(const std::string &key) const {
+               return m_directory + "/" + key + ".rccol";
+          }
+
+     protected:
+          std::string m_directory;
+          std::map<std::string, MappedColumn<T>> m_columns;
+     };
+
+}
+
+#endif
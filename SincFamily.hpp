@@ -0,0 +1,190 @@
+#ifndef _sinc_family_h
+#define _sinc_family_h
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include "Float128.hpp"
+#include "Hyperdual.hpp"
+#include "MathBackend.hpp"
+#include "SecondOrderDual.hpp"
+
+/**
+ * @brief Primitives for the functions whose direct expressions cancel, or divide 0 by 0, near
+ * x = 0, for the real types and for their Hyperdual and SecondOrderDual:
+ *
+ * sinc(x) = sin(x) / x
+ * versinc(x) = (1 - cos(x)) / x^2, evaluated as 2 sin^2(x / 2) / x^2
+ * expm1(x) = exp(x) - 1 and log1p(x) = log(1 + x), from libm for the real types
+ *
+ * The dual versions apply the chain rule to the value and the first two derivatives of the real
+ * function. sinc and versinc are F(x^2) for a series F: below |x| = 2 their derivatives are
+ * 2 x F'(x^2) and 2 F'(x^2) + 4 x^2 F''(x^2), summed from the series, which neither cancel nor
+ * divide by x; beyond, they come from closed forms in sin and cos.
+ *
+ * sinc and versinc take the sin and cos of a MathBackend.hpp backend, StdMath by default, as
+ * their second template parameter.
+ *
+ * The real versions are in rodrigues_formula. The dual ones are next to the other Hyperdual
+ * functions, in the global namespace, and are found by argument dependent lookup.
+ */
+namespace rodrigues_formula
+{
+
+     template < typename Real, class Math = StdMath > Real sinc(Real x)
+     {
+          return x == Real(0) ? Real(1) : Math::sin(x) / x;
+     }
+
+     template < typename Real, class Math = StdMath > Real versinc(Real x)
+     {
+          const Real h = sinc<Real, Math>(x / Real(2));
+          return h * h / Real(2);
+     }
+
+     namespace detail
+     {
+          const unsigned N_INV_FACTORIALS = 64;
+
+          template < typename Real > const std::array<Real, N_INV_FACTORIALS> &inverse_factorials()
+          {
+               struct Table
+               {
+                    std::array<Real, N_INV_FACTORIALS> v;
+                    Table() {
+                         v[0] = Real(1);
+                         for (unsigned n = 1; n < N_INV_FACTORIALS; ++n) v[n] = v[n - 1] / Real(n);
+                    }
+               };
+               static const Table s_table;
+               return s_table.v;
+          }
+
+          /// |x| below which the sinc and versinc derivatives are summed from their series
+          const double SINC_SERIES_LIMIT = 2.0;
+
+          /**
+           * @brief f(x), f'(x) and f''(x) for f = sinc (i = 1) or versinc (i = 2), where
+           * f(x) = F(x^2) = sum_j (-1)^j x^2j / (2j + i)!
+           */
+          template < class Math, typename Real > void sinc_jet(unsigned i, Real x, Real &f, Real &df, Real &d2f)
+          {
+               if (fabs(x) > Real(SINC_SERIES_LIMIT))
+               {
+                    Real s, c;
+                    Math::sincos(x, s, c);
+                    const Real x2 = x * x;
+                    if (i == 1)
+                    {
+                         f = s / x;
+                         df = (c - f) / x;
+                         d2f = -f - Real(2) * df / x;
+                    }
+                    else
+                    {
+                         const Real sh = Math::sin(x / Real(2));
+                         f = Real(2) * sh * sh / x2;
+                         df = (s / x - Real(2) * f) / x;
+                         d2f = (c - Real(2) * f - Real(4) * x * df) / x2;
+                    }
+                    return;
+               }
+               const std::array<Real, N_INV_FACTORIALS> &inv_factorial = inverse_factorials<Real>();
+               const Real u = x * x;
+               const Real eps = std::numeric_limits<Real>::epsilon() / Real(2);
+               // The term j of F, F' and F'' is c_j u^j, j c_j u^(j - 1) and j (j - 1) c_j u^(j - 2).
+               // For u <= 4, the F'' terms are the last to become negligible (relative to sums
+               // that do not vanish there), so they alone stop the summation.
+               Real F = inv_factorial[i] - inv_factorial[i + 2] * u, F1 = -inv_factorial[i + 2], F2(0);
+               Real p(1);
+               for (unsigned j = 2; 2 * j + i < N_INV_FACTORIALS; ++j)
+               {
+                    const Real c = (j % 2) ? -inv_factorial[2 * j + i] : inv_factorial[2 * j + i];
+                    const Real t2 = c * p;
+                    F2 += Real(j * (j - 1)) * t2;
+                    F1 += Real(j) * t2 * u;
+                    F += t2 * u * u;
+                    if (fabs(t2) <= eps * fabs(F2)) break;
+                    p *= u;
+               }
+               f = F;
+               df = Real(2) * x * F1;
+               d2f = Real(2) * F1 + Real(4) * u * F2;
+          }
+
+          /// g(x) from g, g' and g'' at the real part of x
+          template < typename R > Hyperdual<R> chain(Hyperdual<R> x, R g, R dg, R d2g)
+          {
+               return Hyperdual<R>(g, dg * x.eps1(), dg * x.eps2(), dg * x.eps1eps2() + d2g * x.eps1() * x.eps2());
+          }
+
+          template < typename R > SecondOrderDual<R> chain(const SecondOrderDual<R> &x, R g, R dg, R d2g)
+          {
+               return SecondOrderDual<R>(g, dg * x.eps1(), dg * x.eps1eps2() + d2g * x.eps1() * x.eps1());
+          }
+
+          template < class Dual, typename R, class Math > Dual dual_sinc(Dual x, unsigned i)
+          {
+               R f, df, d2f;
+               sinc_jet<Math>(i, x.real(), f, df, d2f);
+               return chain(x, f, df, d2f);
+          }
+
+          template < class Dual, typename R > Dual dual_expm1(Dual x)
+          {
+               const R r = x.real();
+               const R e = exp(r);
+               return chain(x, R(expm1(r)), e, e);
+          }
+
+          template < class Dual, typename R > Dual dual_log1p(Dual x)
+          {
+               const R r = x.real();
+               const R d = R(1) / (R(1) + r);
+               return chain(x, R(log1p(r)), d, -d * d);
+          }
+     }
+
+}
+
+template < typename R, class Math = rodrigues_formula::StdMath > Hyperdual<R> sinc(const Hyperdual<R> &x)
+{
+     return rodrigues_formula::detail::dual_sinc<Hyperdual<R>, R, Math>(x, 1);
+}
+
+template < typename R, class Math = rodrigues_formula::StdMath > Hyperdual<R> versinc(const Hyperdual<R> &x)
+{
+     return rodrigues_formula::detail::dual_sinc<Hyperdual<R>, R, Math>(x, 2);
+}
+
+template < typename R > Hyperdual<R> expm1(const Hyperdual<R> &x)
+{
+     return rodrigues_formula::detail::dual_expm1<Hyperdual<R>, R>(x);
+}
+
+template < typename R > Hyperdual<R> log1p(const Hyperdual<R> &x)
+{
+     return rodrigues_formula::detail::dual_log1p<Hyperdual<R>, R>(x);
+}
+
+template < typename R, class Math = rodrigues_formula::StdMath > SecondOrderDual<R> sinc(const SecondOrderDual<R> &x)
+{
+     return rodrigues_formula::detail::dual_sinc<SecondOrderDual<R>, R, Math>(x, 1);
+}
+
+template < typename R, class Math = rodrigues_formula::StdMath > SecondOrderDual<R> versinc(const SecondOrderDual<R> &x)
+{
+     return rodrigues_formula::detail::dual_sinc<SecondOrderDual<R>, R, Math>(x, 2);
+}
+
+template < typename R > SecondOrderDual<R> expm1(const SecondOrderDual<R> &x)
+{
+     return rodrigues_formula::detail::dual_expm1<SecondOrderDual<R>, R>(x);
+}
+
+template < typename R > SecondOrderDual<R> log1p(const SecondOrderDual<R> &x)
+{
+     return rodrigues_formula::detail::dual_log1p<SecondOrderDual<R>, R>(x);
+}
+
+#endif
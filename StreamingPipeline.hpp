@@ -0,0 +1,162 @@
+#ifndef _streaming_pipeline_h
+#define _streaming_pipeline_h
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rodrigues_formula
+{
+
+     /**
+      * @brief Blocking FIFO queue that can be closed. Once closed, pop() drains the remaining items
+      * and then returns false.
+      */
+     template < typename T > class BlockingQueue
+     {
+     public:
+          void push(T v) {
+               {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_items.push_back(v);
+               }
+               m_cv.notify_one();
+          }
+
+          bool pop(T &v) {
+               std::unique_lock<std::mutex> lock(m_mutex);
+               m_cv.wait(lock, [this] { return m_closed || !m_items.empty(); });
+               if (m_items.empty()) return false;
+               v = m_items.front();
+               m_items.pop_front();
+               return true;
+          }
+
+          void close() {
+               {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_closed = true;
+               }
+               m_cv.notify_all();
+          }
+
+     protected:
+          std::mutex m_mutex;
+          std::condition_variable m_cv;
+          std::deque<T> m_items;
+          bool m_closed = false;
+     };
+
+     /**
+      * @brief Three-stage generate -> evaluate -> reduce pipeline over a fixed pool of chunks.
+      *
+      * One thread generates chunks, n_evaluators threads evaluate them and the calling thread
+      * reduces them, so that the stages overlap. Reduced chunks go back to the generator, hence the
+      * memory in use is bounded by the chunk pool regardless of the length of the stream. Chunks
+      * may reach the reducer in any order.
+      *
+      * generate(Chunk &) fills the next chunk and returns false when the stream is over;
+      * evaluate(Chunk &) and reduce(Chunk &) process it. The first exception thrown by any stage
+      * stops the pipeline and is rethrown by run().
+      */
+     template < typename Chunk > class StreamingPipeline
+     {
+     public:
+          explicit StreamingPipeline(unsigned n_evaluators) :
+               m_n_evaluators(n_evaluators ? n_evaluators : 1) { }
+
+          unsigned evaluators() const {
+               return m_n_evaluators;
+          }
+
+          template < class Generate, class Evaluate, class Reduce >
+          void run(std::vector<Chunk> &pool, Generate generate, Evaluate evaluate, Reduce reduce) {
+               BlockingQueue<Chunk *> free, generated, evaluated;
+               std::exception_ptr error;
+               std::mutex error_mutex;
+               std::atomic<bool> failed(false);
+               auto fail = [&]() {
+                    {
+                         std::lock_guard<std::mutex> lock(error_mutex);
+                         if (!error) error = std::current_exception();
+                    }
+                    failed.store(true);
+                    free.close();
+                    generated.close();
+                    evaluated.close();
+               };
+
+               for (auto &c : pool) free.push(&c);
+
+               std::thread generator([&]() {
+                         try
+                         {
+                              Chunk *c;
+                              while (!failed.load() && free.pop(c))
+                              {
+                                   if (!generate(*c)) break;
+                                   generated.push(c);
+                              }
+                         }
+                         catch (...)
+                         {
+                              fail();
+                         }
+                         generated.close();
+                    });
+
+               std::atomic<unsigned> running(m_n_evaluators);
+               std::vector<std::thread> evaluators;
+               for (unsigned e = 0; e < m_n_evaluators; ++e)
+               {
+                    evaluators.emplace_back([&]() {
+                              try
+                              {
+                                   Chunk *c;
+                                   while (!failed.load() && generated.pop(c))
+                                   {
+                                        evaluate(*c);
+                                        evaluated.push(c);
+                                   }
+                              }
+                              catch (...)
+                              {
+                                   fail();
+                              }
+                              if (--running == 0) evaluated.close();
+                         });
+               }
+
+               try
+               {
+                    Chunk *c;
+                    while (!failed.load() && evaluated.pop(c))
+                    {
+                         reduce(*c);
+                         free.push(c);
+                    }
+               }
+               catch (...)
+               {
+                    fail();
+               }
+               // Releases the generator if it is waiting for a chunk after a failure
+               free.close();
+
+               generator.join();
+               for (auto &t : evaluators) t.join();
+               if (error) std::rethrow_exception(error);
+          }
+
+     protected:
+          unsigned m_n_evaluators;
+     };
+
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef _thread_counters_h
+#define _thread_counters_h
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace rodrigues_formula
+{
+
+     /**
+      * @brief N event counters per thread, summed on demand over every thread.
+      *
+      * Each thread increments its own counters, created on its first add(), without
+      * synchronisation. total() sums them over every thread that counted something, alive or
+      * already finished: a thread registers its counters on creation and, on exit, adds them to
+      * the retired sums. Tag tells apart the independent sets of counters (one per user class).
+      */
+     template < std::size_t N, class Tag > class ThreadCounters
+     {
+     public:
+          typedef std::array<std::uint64_t, N> Values;
+
+          /**
+           * @brief Adds n to the counter i of the calling thread
+           */
+          static void add(std::size_t i, std::uint64_t n = 1) {
+               std::atomic<std::uint64_t> &v = local().values[i];
+               v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+          }
+
+          /**
+           * @brief Counters of the calling thread
+           */
+          static Values thread_values() {
+               return local().snapshot();
+          }
+
+          /**
+           * @brief Counters summed over every thread
+           */
+          static Values total() {
+               Registry &r = registry();
+               std::lock_guard<std::mutex> lock(r.mutex);
+               Values v = r.retired;
+               for (const Local *t : r.threads) merge(v, t->snapshot());
+               return v;
+          }
+
+     protected:
+          struct Local;
+
+          struct Registry
+          {
+               std::mutex mutex;
+               std::vector<const Local *> threads;
+               /// Counters of the threads already finished
+               Values retired = Values();
+          };
+
+          static Registry &registry() {
+               static Registry r;
+               return r;
+          }
+
+          struct Local
+          {
+               /// Written by the owning thread only, read by total() from any thread
+               std::atomic<std::uint64_t> values[N];
+
+               Local() {
+                    for (std::size_t i = 0; i < N; ++i) values[i].store(0, std::memory_order_relaxed);
+                    Registry &r = registry();
+                    std::lock_guard<std::mutex> lock(r.mutex);
+                    r.threads.push_back(this);
+               }
+
+               ~Local() {
+                    Registry &r = registry();
+                    std::lock_guard<std::mutex> lock(r.mutex);
+                    merge(r.retired, snapshot());
+                    for (auto it = r.threads.begin(); it != r.threads.end(); ++it)
+                    {
+                         if (*it == this)
+                         {
+                              r.threads.erase(it);
+                              break;
+                         }
+                    }
+               }
+
+               Values snapshot() const {
+                    Values v;
+                    for (std::size_t i = 0; i < N; ++i) v[i] = values[i].load(std::memory_order_relaxed);
+                    return v;
+               }
+          };
+
+          static Local &local() {
+               static thread_local Local l;
+               return l;
+          }
+
+          static void merge(Values &to, const Values &from) {
+               for (std::size_t i = 0; i < N; ++i) to[i] += from[i];
+          }
+     };
+
+}
+
+#endif
@@ -0,0 +1,1639 @@
+#ifndef _trigonometric_coeffs_h
+#define _trigonometric_coeffs_h
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include "CoefficientTable.hpp"
+#include "Float128.hpp"
+#include "Hyperdual.hpp"
+#include "Instrumentation.hpp"
+#include "MathBackend.hpp"
+#include "SecondOrderDual.hpp"
+#include "SincFamily.hpp"
+
+/**
+ * @brief Namespace with the implementation of Ritto-Correa's Rodrigue's formula coefficients using
+ * different numerical methods.
+ *
+ * b_i = \frac{1}{\theta} \diff{a_i(\theta)}{\theta}
+ * c_i = \frac{1}{\theta} \diff{b_i(\theta)}{\theta}
+ */
+namespace rodrigues_formula
+{
+
+     enum class CalculationMode { Direct, NumericHyperDual, SeriesExpansion, Table, MixedPrecision, HalfAngle, AdaptiveSeries, HyperDualSeries };
+
+     /**
+      * @brief Short name of a calculation mode, as used in the program output
+      */
+     inline const char *mode_name(CalculationMode mode)
+     {
+          switch (mode)
+          {
+          case CalculationMode::Direct: return "direct";
+          case CalculationMode::NumericHyperDual: return "hyperdual";
+          case CalculationMode::SeriesExpansion: return "series";
+          case CalculationMode::Table: return "table";
+          case CalculationMode::MixedPrecision: return "mixed";
+          case CalculationMode::HalfAngle: return "half-angle";
+          case CalculationMode::AdaptiveSeries: return "adaptive";
+          case CalculationMode::HyperDualSeries: return "hyperdual-series";
+          }
+          return "unknown";
+     }
+
+     /**
+      * @brief Angle range hints: the range of |theta| that the caller guarantees, as the last
+      * template parameter of TrigonometricCoeffs. They cost nothing at run time: the branches
+      * between the series and the direct expressions, and the Table mode fallback, that the
+      * range excludes are removed at compile time, and ranges within |theta| <= pi evaluate sin
+      * and cos with BoundedPiMath, without argument reduction. Angles outside of the hinted
+      * range are a precondition violation.
+      *
+      * Unbounded: any angle (the default)
+      * BoundedPi: |theta| <= pi, e.g. rotation vector magnitudes
+      * SmallAngle<Num, Den>: |theta| <= Num / Den, e.g. SmallAngle<1, 1000> for 1e-3; with a
+      *                       bound below the series thresholds the series modes reduce to their
+      *                       polynomials
+      */
+     struct Unbounded
+     {
+          static constexpr long double max_abs() { return std::numeric_limits<long double>::infinity(); }
+     };
+
+     struct BoundedPi
+     {
+          static constexpr long double max_abs() { return 3.14159265358979323846264338327950288L; }
+     };
+
+     template < std::intmax_t Num, std::intmax_t Den = 1 > struct SmallAngle
+     {
+          static_assert(Num > 0 && Den > 0, "The angle bound must be positive");
+          static constexpr long double max_abs() { return static_cast<long double>(Num) / Den; }
+     };
+
+     /**
+      * @brief Default policy, holding the compile-time parameters of the calculation modes that
+      * need them. Custom policies provide the same static members.
+      *
+      * hyperdual_h1, hyperdual_h2: hyper-dual steps of the NumericHyperDual mode; equal steps let
+      *                             it use SecondOrderDual instead of Hyperdual
+      * table_theta_max: |theta| range covered by the Table mode lookup table
+      * table_tolerance: maximum interpolation error of the Table mode, relative to the magnitude
+      *                  of each coefficient over the range
+      * incremental_max_step: largest |delta theta| IncrementalCoeffs updates by angle addition
+      * incremental_max_drift: largest |delta theta| accumulated by IncrementalCoeffs between two
+      *                        full evaluations, which bounds the error of its sin and cos
+      * incremental_max_updates: angle additions allowed before a full re-evaluation
+      * horizontal_series: whether the SeriesExpansion bundle evaluates its series side by side in
+      *                    SIMD lanes, where T supports it
+      * Math: backend of the sin and cos evaluations (see MathBackend.hpp)
+      * AngleRange: range hint, set by TrigonometricCoeffs from its Range parameter
+      */
+     struct DefaultPolicy
+     {
+          typedef StdMath Math;
+          typedef Unbounded AngleRange;
+
+          template < typename T > static constexpr T hyperdual_h1() { return T(1e-10); }
+          template < typename T > static constexpr T hyperdual_h2() { return T(1e-10); }
+          template < typename T > static constexpr long double table_theta_max() {
+               return 3.14159265358979323846264338327950288L;
+          }
+          /// The table is built in long double, which bounds its accuracy for the wider types
+          template < typename T > static constexpr long double table_tolerance() {
+               return 8 * (std::numeric_limits<T>::digits < std::numeric_limits<long double>::digits
+                           ? static_cast<long double>(std::numeric_limits<T>::epsilon())
+                           : std::numeric_limits<long double>::epsilon());
+          }
+          template < typename T > static constexpr T incremental_max_step() { return T(0.0625); }
+          template < typename T > static constexpr T incremental_max_drift() { return T(0.25); }
+          static constexpr unsigned incremental_max_updates() { return 1024; }
+          static constexpr bool horizontal_series() { return true; }
+     };
+
+     template < typename T, class Policy > class IncrementalCoeffs;
+
+     /**
+      * @brief All the coefficients at a given theta, as returned by the fused evaluation
+      */
+     template < typename T > struct CoefficientBundle
+     {
+          T a0, a1, a2;
+          T b0, b1, b2;
+          T c0, c1, c2;
+     };
+
+     namespace detail
+     {
+          /**
+           * @brief Number of terms of the level k series (a_i: 0, b_i: 1, c_i: 2, see
+           * series_coefficient()) needed for u = theta^2 <= u_max in a type of the given binary
+           * digits: terms are added until their ratio to the first one falls below 2^-(digits + 1).
+           *
+           * The ratio of the terms j + 1 and j is u (2j + 2) / ((2j + 2 - 2k) (2j + 1) (2j + 2))
+           * for i = 0, which bounds the other i.
+           */
+          constexpr unsigned series_terms_from(unsigned k, long double u_max, long double eps,
+                                               unsigned j, long double ratio)
+          {
+               return ratio < eps ? j - k
+                    : series_terms_from(k, u_max, eps, j + 1,
+                                        ratio * u_max * (2 * j + 2) / ((2 * j + 2 - 2 * k) * (2 * j + 1) * (2 * j + 2.0L)));
+          }
+
+          constexpr long double series_pow2(int e)
+          {
+               return e == 0 ? 1.0L : (e < 0 ? series_pow2(e + 1) / 2 : 2 * series_pow2(e - 1));
+          }
+
+          constexpr unsigned series_terms(unsigned k, long double u_max, int digits)
+          {
+               return series_terms_from(k, u_max, series_pow2(-digits - 1), k, 1.0L);
+          }
+
+#if defined(__AVX__)
+          const std::size_t SIMD_BYTES = 32;
+#else
+          const std::size_t SIMD_BYTES = 16;
+#endif
+
+          template < typename T, std::size_t BYTES > struct LaneVector
+          {
+               typedef T type __attribute__((vector_size(BYTES)));
+          };
+
+          /**
+           * @brief Vector of T (GCC vector extension) of the target SIMD width (up to 256 bits)
+           * for the horizontal evaluation of the series bundle, or void to keep the scalar chains.
+           * Generic vectors wider than the target registers are lowered through the stack.
+           *
+           * Only double gains: the float series are at most 5 terms long, so Estrin's scheme saves
+           * two steps, which the broadcasts and lane extractions cost back (measured 20 % slower).
+           */
+          template < typename T > struct SeriesLanes { typedef void type; };
+          template <> struct SeriesLanes<double> : LaneVector<double, SIMD_BYTES> { };
+
+          /**
+           * @brief Bundle evaluation coefficient by coefficient, for the modes with no shared work
+           */
+          template < class Impl, typename T > CoefficientBundle<T> generic_bundle(T theta)
+          {
+               CoefficientBundle<T> r;
+               r.a0 = Impl::a0(theta);
+               r.a1 = Impl::a1(theta);
+               r.a2 = Impl::a2(theta);
+               r.b0 = Impl::b0(theta);
+               r.b1 = Impl::b1(theta);
+               r.b2 = Impl::b2(theta);
+               r.c0 = Impl::c0(theta);
+               r.c1 = Impl::c1(theta);
+               r.c2 = Impl::c2(theta);
+               return r;
+          }
+
+          /**
+           * @brief Batch bundle evaluation of the modes with a bundle(theta, sin, cos) overload:
+           * sin and cos come from the batch sincos of the Math backend, by blocks
+           */
+          template < class Impl, class Math, typename T >
+          void batch_bundle(const T *theta, std::size_t n, CoefficientBundle<T> *out, std::true_type)
+          {
+               const std::size_t BLOCK = 256;
+               T s[BLOCK], c[BLOCK];
+               for (std::size_t i = 0; i < n; i += BLOCK)
+               {
+                    const std::size_t m = n - i < BLOCK ? n - i : BLOCK;
+                    Math::sincos(theta + i, s, c, m);
+                    for (std::size_t j = 0; j < m; ++j) out[i + j] = Impl::bundle(theta[i + j], s[j], c[j]);
+               }
+          }
+
+          template < class Impl, class Math, typename T >
+          void batch_bundle(const T *theta, std::size_t n, CoefficientBundle<T> *out, std::false_type)
+          {
+               for (std::size_t i = 0; i < n; ++i) out[i] = Impl::bundle(theta[i]);
+          }
+
+          /**
+           * @brief Policy of the implementation, with the angle range hint and the sin / cos
+           * backend it implies
+           */
+          template < class Policy, class Range > struct RangedPolicy : Policy
+          {
+               typedef Range AngleRange;
+               typedef typename std::conditional<(Range::max_abs() <= BoundedPi::max_abs()),
+                                                 BoundedPiMath, typename Policy::Math>::type Math;
+          };
+
+          template < class Policy, class Range > struct ApplyRange
+          {
+               typedef RangedPolicy<Policy, Range> type;
+          };
+
+          /// No hint: the policy itself, so that the implementations are shared
+          template < class Policy > struct ApplyRange<Policy, Unbounded>
+          {
+               typedef Policy type;
+          };
+
+          /**
+           * @brief True when the angle range hint of the policy guarantees |theta| <= bound
+           */
+          template < class Policy > constexpr bool within_range(long double bound)
+          {
+               return Policy::AngleRange::max_abs() <= bound;
+          }
+
+          /**
+           * @brief |theta| > threshold, for the switches between the series and the direct
+           * expressions: constant false when the range hint rules it out, so that the compiler
+           * removes the test and the direct branch
+           */
+          template < class Policy, typename T > bool beyond(T theta, long double threshold)
+          {
+               return !within_range<Policy>(threshold) && fabs(theta) > T(threshold);
+          }
+
+          template < typename T, CalculationMode mode >
+          class DependentFalse : std::false_type
+          { };
+
+          template < typename T, CalculationMode mode, class Policy = DefaultPolicy > class TrigonometricCoeffsImpl
+          {
+          public:
+               static T a0(T theta) {
+                    static_assert(DependentFalse<T, mode>::value, "no default implementation");
+               }
+
+               static T a1(T theta) {
+                    static_assert(DependentFalse<T, mode>::value, "no default implementation");
+               }
+
+               static T a2(T theta) {
+                    static_assert(DependentFalse<T, mode>::value, "no default implementation");
+               }
+          };
+     }
+
+     /**
+      * @brief Template class with the public interface for the coefficients implementation.
+      *
+      * The class is empty: the coefficients are static members of empty functor types that
+      * dispatch statically to the implementation, so instances can be freely copied and embedded
+      * in other data at no cost, and every call chain can be inlined.
+      *
+      * @tparam T The underlying real type to be used (float, double)
+      * @tparam CalculationMode The calculation mode to be used. One of the \ref
+      * CalculationMode enum values.
+      * @tparam Policy Compile-time parameters of the calculation mode. See \ref DefaultPolicy.
+      * @tparam Range Range of |theta| guaranteed by the caller. See \ref Unbounded.
+      */
+     template < typename T, CalculationMode mode, class Policy = DefaultPolicy, class Range = Unbounded >
+     class TrigonometricCoeffs
+     {
+     public:
+          typedef detail::TrigonometricCoeffsImpl<T, mode, typename detail::ApplyRange<Policy, Range>::type> Impl;
+          typedef T RealType;
+          typedef CoefficientBundle<T> Bundle;
+
+          static const char *name() {
+               return mode_name(mode);
+          }
+
+          /**
+           * @brief Fused evaluation of all the coefficients, sharing the common work where the
+           * mode allows it (e.g. a single sin / cos evaluation)
+           */
+          static Bundle bundle(T theta) {
+               const Bundle r = Impl::bundle(theta);
+               count_non_finite(r);
+               return r;
+          }
+
+          /**
+           * @brief Bundles of theta[0], ..., theta[n - 1]. The Direct and series modes get sin and
+           * cos from the batch sincos of the policy's Math backend.
+           */
+          static void bundle(const T *theta, std::size_t n, Bundle *out) {
+               typedef std::integral_constant<bool, mode == CalculationMode::Direct ||
+                                              mode == CalculationMode::SeriesExpansion ||
+                                              mode == CalculationMode::AdaptiveSeries> HasSinCosBundle;
+               detail::batch_bundle<Impl, typename Impl::Math>(theta, n, out, HasSinCosBundle());
+               for (std::size_t i = 0; i < n; ++i) count_non_finite(out[i]);
+          }
+
+#define RODRIGUES_COEFFICIENT_FUNCTOR(Name, member)     \
+          struct Name                                   \
+          {                                             \
+               T operator()(T theta) const {            \
+                    const T v = Impl::member(theta);    \
+                    RODRIGUES_COUNT_NON_FINITE(v);      \
+                    return v;                           \
+               }                                        \
+          };
+
+          RODRIGUES_COEFFICIENT_FUNCTOR(A0, a0)
+          RODRIGUES_COEFFICIENT_FUNCTOR(A1, a1)
+          RODRIGUES_COEFFICIENT_FUNCTOR(A2, a2)
+          RODRIGUES_COEFFICIENT_FUNCTOR(B0, b0)
+          RODRIGUES_COEFFICIENT_FUNCTOR(B1, b1)
+          RODRIGUES_COEFFICIENT_FUNCTOR(B2, b2)
+          RODRIGUES_COEFFICIENT_FUNCTOR(C0, c0)
+          RODRIGUES_COEFFICIENT_FUNCTOR(C1, c1)
+          RODRIGUES_COEFFICIENT_FUNCTOR(C2, c2)
+
+#undef RODRIGUES_COEFFICIENT_FUNCTOR
+
+          static constexpr A0 a0{};
+          static constexpr A1 a1{};
+          static constexpr A2 a2{};
+          static constexpr B0 b0{};
+          static constexpr B1 b1{};
+          static constexpr B2 b2{};
+          static constexpr C0 c0{};
+          static constexpr C1 c1{};
+          static constexpr C2 c2{};
+
+          static T d(A0, T theta) {
+               return Impl::da0(theta);
+          }
+
+          static T d(A1, T theta) {
+               return Impl::da1(theta);
+          }
+
+          static T d(A2, T theta) {
+               return Impl::da2(theta);
+          }
+
+          static T d2(A0, T theta) {
+               return Impl::d2a0(theta);
+          }
+
+          static T d2(A1, T theta) {
+               return Impl::d2a1(theta);
+          }
+
+          static T d2(A2, T theta) {
+               return Impl::d2a2(theta);
+          }
+
+     protected:
+          static void count_non_finite(const Bundle &r) {
+               RODRIGUES_COUNT_NON_FINITE(r.a0); RODRIGUES_COUNT_NON_FINITE(r.a1); RODRIGUES_COUNT_NON_FINITE(r.a2);
+               RODRIGUES_COUNT_NON_FINITE(r.b0); RODRIGUES_COUNT_NON_FINITE(r.b1); RODRIGUES_COUNT_NON_FINITE(r.b2);
+               RODRIGUES_COUNT_NON_FINITE(r.c0); RODRIGUES_COUNT_NON_FINITE(r.c1); RODRIGUES_COUNT_NON_FINITE(r.c2);
+          }
+     };
+
+#define RODRIGUES_COEFFICIENT_DEFINITION(Name, member)                  \
+     template < typename T, CalculationMode mode, class Policy, class Range > \
+     constexpr typename TrigonometricCoeffs<T, mode, Policy, Range>::Name TrigonometricCoeffs<T, mode, Policy, Range>::member;
+
+     RODRIGUES_COEFFICIENT_DEFINITION(A0, a0)
+     RODRIGUES_COEFFICIENT_DEFINITION(A1, a1)
+     RODRIGUES_COEFFICIENT_DEFINITION(A2, a2)
+     RODRIGUES_COEFFICIENT_DEFINITION(B0, b0)
+     RODRIGUES_COEFFICIENT_DEFINITION(B1, b1)
+     RODRIGUES_COEFFICIENT_DEFINITION(B2, b2)
+     RODRIGUES_COEFFICIENT_DEFINITION(C0, c0)
+     RODRIGUES_COEFFICIENT_DEFINITION(C1, c1)
+     RODRIGUES_COEFFICIENT_DEFINITION(C2, c2)
+
+#undef RODRIGUES_COEFFICIENT_DEFINITION
+
+     namespace detail
+     {
+          template <typename T, class Policy>
+          class TrigonometricCoeffsImpl<T, CalculationMode::Direct, Policy>
+          {
+          public:
+               typedef typename Policy::Math Math;
+               static T a0(T theta) {
+                    return Math::cos(theta);
+               }
+
+               static T a1(T theta) {
+                    return Math::sin(theta) / theta;
+               }
+
+               static T a2(T theta) {
+                    return (T(1) - Math::cos(theta)) / (theta * theta);
+               }
+
+               static T da0(T theta) {
+                    return -Math::sin(theta);
+               }
+
+               static T da1(T theta) {
+                    return (theta * Math::cos(theta) - Math::sin(theta)) / (theta * theta);
+               }
+
+               static T da2(T theta) {
+                    return (theta * Math::sin(theta) + T(2) * Math::cos(theta) - T(2)) / pow(theta, 3);
+               }
+
+               static T d2a0(T theta) {
+                    return -Math::cos(theta);
+               }
+
+               static T d2a1(T theta) {
+                    return -((pow(theta, 2) - 2) * Math::sin(theta) + 2 * theta * Math::cos(theta)) / pow(theta, 3);
+               }
+
+               static T d2a2(T theta) {
+                    return ((pow(theta, 2) - 6) * Math::cos(theta) - 4 * theta * Math::sin(theta) + 6) / pow(theta, 4);
+               }
+
+               static T b0(T theta) {
+                    return -Math::sin(theta) / theta;
+               }
+
+               /**
+                * b_1 = \frac{1}{\theta} \diff{a_1(\theta)}{\theta}
+                */
+               static T b1(T theta) {
+                    return (theta * Math::cos(theta) - Math::sin(theta)) / pow(theta, 3);
+               }
+
+               /**
+                * b_2 = \frac{1}{\theta} \diff{a_2(\theta)}{\theta}
+                */
+               static T b2(T theta) {
+                    return (theta * Math::sin(theta) + T(2) * Math::cos(theta) - T(2)) / pow(theta, 4);
+               }
+
+               /**
+                * c_0 = \frac{1}{\theta} \diff{b_0(\theta)}{\theta} = -b_1
+                */
+               static T c0(T theta) {
+                    return (Math::sin(theta) - theta * Math::cos(theta)) / pow(theta, 3);
+               }
+
+               /**
+                * c_1 = \frac{1}{\theta} \diff{b_1(\theta)}{\theta}
+                */
+               static T c1(T theta) {
+                    return (T(3) * Math::sin(theta) - T(3) * theta * Math::cos(theta) - pow(theta, 2) * Math::sin(theta)) / pow(theta, 5);
+               }
+
+               /**
+                * c_2 = \frac{1}{\theta} \diff{b_2(\theta)}{\theta}
+                */
+               static T c2(T theta) {
+                    return (pow(theta, 2) * Math::cos(theta) - T(5) * theta * Math::sin(theta) - T(8) * Math::cos(theta) + T(8)) / pow(theta, 6);
+               }
+
+               static CoefficientBundle<T> bundle(T theta) {
+                    T s, c;
+                    Math::sincos(theta, s, c);
+                    return bundle(theta, s, c);
+               }
+
+               /**
+                * @brief All the coefficients from already known s = sin(theta) and c = cos(theta)
+                */
+               static CoefficientBundle<T> bundle(T theta, T s, T c) {
+                    const T inv = T(1) / theta;
+                    const T inv2 = inv * inv;
+                    const T inv3 = inv2 * inv;
+                    const T ts = theta * s, tc = theta * c;
+                    CoefficientBundle<T> r;
+                    r.a0 = c;
+                    r.a1 = s * inv;
+                    r.a2 = (T(1) - c) * inv2;
+                    r.b0 = -r.a1;
+                    r.b1 = (tc - s) * inv3;
+                    r.b2 = (ts + T(2) * c - T(2)) * inv2 * inv2;
+                    r.c0 = -r.b1;
+                    r.c1 = (T(3) * s - T(3) * tc - theta * ts) * inv3 * inv2;
+                    r.c2 = (theta * tc - T(5) * ts - T(8) * c + T(8)) * inv3 * inv3;
+                    return r;
+               }
+          };
+
+          template <class T, class Policy>
+          class TrigonometricCoeffsImpl<T, CalculationMode::NumericHyperDual, Policy>
+          {
+          public:
+               typedef typename Policy::Math Math;
+               using RealType = T;
+
+               static RealType a0(RealType theta) {
+                    return Math::cos(theta);
+               }
+
+               static RealType a1(RealType theta) {
+                    return sinc<RealType, Math>(theta);
+               }
+
+               static RealType a2(RealType theta) {
+                    return versinc<RealType, Math>(theta);
+               }
+
+               static RealType da0(RealType theta) {
+                    return _a0(theta).eps1() / S_H1;
+               }
+
+               static RealType da1(RealType theta) {
+                    return _a1(theta).eps1() / S_H1;
+               }
+
+               static RealType da2(RealType theta) {
+                    return _a2(theta).eps1() / S_H1;
+               }
+
+               static RealType d2a0(RealType theta) {
+                    return _a0(theta).eps1eps2() / (S_H1 * S_H2);
+               }
+
+               static RealType d2a1(RealType theta) {
+                    return _a1(theta).eps1eps2() / (S_H1 * S_H2);
+               }
+
+               static RealType d2a2(RealType theta) {
+                    return _a2(theta).eps1eps2() / (S_H1 * S_H2);
+               }
+
+               static RealType b0(RealType theta) {
+                    if (theta == RealType(0)) return SeriesImpl::b0(theta);
+                    return da0(theta) / theta;
+               }
+
+               static RealType b1(RealType theta) {
+                    if (theta == RealType(0)) return SeriesImpl::b1(theta);
+                    return da1(theta) / theta;
+               }
+
+               static RealType b2(RealType theta) {
+                    if (theta == RealType(0)) return SeriesImpl::b2(theta);
+                    return da2(theta) / theta;
+               }
+
+               /**
+                * c_i = \frac{1}{\theta} \diff{b_i}{\theta} = (\diff[2]{a_i}{\theta} - b_i) / \theta^2
+                *
+                * The b_i and c_i quotients are 0 / 0 at theta = 0, where they take their limits from
+                * the series.
+                */
+               static RealType c0(RealType theta) {
+                    if (theta == RealType(0)) return SeriesImpl::c0(theta);
+                    return (d2a0(theta) - b0(theta)) / (theta * theta);
+               }
+
+               static RealType c1(RealType theta) {
+                    if (theta == RealType(0)) return SeriesImpl::c1(theta);
+                    return (d2a1(theta) - b1(theta)) / (theta * theta);
+               }
+
+               static RealType c2(RealType theta) {
+                    if (theta == RealType(0)) return SeriesImpl::c2(theta);
+                    return (d2a2(theta) - b2(theta)) / (theta * theta);
+               }
+
+               static CoefficientBundle<RealType> bundle(RealType theta) {
+                    return generic_bundle<TrigonometricCoeffsImpl>(theta);
+               }
+
+          protected:
+               typedef TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion, Policy> SeriesImpl;
+
+               static constexpr RealType S_H1 = Policy::template hyperdual_h1<RealType>();
+               static constexpr RealType S_H2 = Policy::template hyperdual_h2<RealType>();
+
+               /// Compared in long double, where the policy steps are constant expressions for any T
+               static const bool SAME_STEPS =
+                    Policy::template hyperdual_h1<long double>() == Policy::template hyperdual_h2<long double>();
+               /// With equal steps both dual parts stay equal: SecondOrderDual stores and computes them once
+               typedef typename std::conditional<SAME_STEPS, SecondOrderDual<RealType>, Hyperdual<RealType>>::type Dual;
+
+               static Dual seed(RealType theta) {
+                    return seed(theta, std::integral_constant<bool, SAME_STEPS>());
+               }
+
+               static SecondOrderDual<RealType> seed(RealType theta, std::true_type) {
+                    return SecondOrderDual<RealType>(theta, S_H1, 0);
+               }
+
+               static Hyperdual<RealType> seed(RealType theta, std::false_type) {
+                    return Hyperdual<RealType>(theta, S_H1, S_H2, 0);
+               }
+
+               static Dual _a0(RealType theta) {
+                    Dual theta_hat = seed(theta);
+                    auto res = Math::cos(theta_hat);
+                    return res;
+               }
+
+               /// sinc and versinc, whose derivatives do not cancel near 0 (see SincFamily.hpp)
+               static Dual _a1(RealType theta) {
+                    return ::sinc<RealType, Math>(seed(theta));
+               }
+
+               static Dual _a2(RealType theta) {
+                    return ::versinc<RealType, Math>(seed(theta));
+               }
+
+          };
+
+          // Definitions of the constants, for types passed by reference (e.g. DoubleDouble)
+          template <class T, class Policy> constexpr T
+          TrigonometricCoeffsImpl<T, CalculationMode::NumericHyperDual, Policy>::S_H1;
+          template <class T, class Policy> constexpr T
+          TrigonometricCoeffsImpl<T, CalculationMode::NumericHyperDual, Policy>::S_H2;
+
+          template <typename T, class Policy>
+          class TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion, Policy>
+          {
+          public:
+               typedef typename Policy::Math Math;
+               static T a0(T theta) {
+                    return DirectImpl::a0(theta);
+               }
+
+#define RODRIGUES_SERIES_COEFFICIENT(member, threshold, level, i)       \
+               static T member(T theta) {                               \
+                    if (beyond<Policy>(theta, threshold))               \
+                    {                                                   \
+                         RODRIGUES_COUNT(SeriesDirectTaken);            \
+                         return DirectImpl::member(theta);              \
+                    }                                                   \
+                    RODRIGUES_COUNT(SeriesTaken);                       \
+                    return level(i, theta);                             \
+               }
+
+               RODRIGUES_SERIES_COEFFICIENT(a1, S_THRESHOLD, ai, 1)
+               RODRIGUES_SERIES_COEFFICIENT(a2, S_THRESHOLD, ai, 2)
+               RODRIGUES_SERIES_COEFFICIENT(b0, S_THRESHOLD, bi, 0)
+               RODRIGUES_SERIES_COEFFICIENT(b1, S_THRESHOLD, bi, 1)
+               RODRIGUES_SERIES_COEFFICIENT(b2, S_THRESHOLD, bi, 2)
+               RODRIGUES_SERIES_COEFFICIENT(c0, S_C_THRESHOLD, ci, 0)
+               RODRIGUES_SERIES_COEFFICIENT(c1, S_C_THRESHOLD, ci, 1)
+               RODRIGUES_SERIES_COEFFICIENT(c2, S_C_THRESHOLD, ci, 2)
+
+#undef RODRIGUES_SERIES_COEFFICIENT
+
+               static CoefficientBundle<T> bundle(T theta) {
+                    if (beyond<Policy>(theta, S_THRESHOLD))
+                    {
+                         T s, c;
+                         Math::sincos(theta, s, c);
+                         return bundle(theta, s, c);
+                    }
+                    return generic_bundle<TrigonometricCoeffsImpl>(theta);
+               }
+
+               /**
+                * @brief All the coefficients from already known s = sin(theta) and c = cos(theta)
+                */
+               static CoefficientBundle<T> bundle(T theta, T s, T c) {
+                    if (beyond<Policy>(theta, S_C_THRESHOLD))
+                    {
+                         RODRIGUES_COUNT_N(SeriesDirectTaken, 8);
+                         return DirectImpl::bundle(theta, s, c);
+                    }
+                    CoefficientBundle<T> r;
+                    if (beyond<Policy>(theta, S_THRESHOLD))
+                    {
+                         RODRIGUES_COUNT_N(SeriesDirectTaken, 5);
+                         RODRIGUES_COUNT_N(SeriesTaken, 3);
+                         r = DirectImpl::bundle(theta, s, c);
+                    }
+                    else
+                    {
+                         RODRIGUES_COUNT_N(SeriesTaken, 8);
+                         r.a0 = c;
+                         series_bundle(theta, r, std::integral_constant<bool, HAS_LANES>());
+                         return r;
+                    }
+                    r.c0 = ci(0, theta);
+                    r.c1 = ci(1, theta);
+                    r.c2 = ci(2, theta);
+                    return r;
+               }
+
+          protected:
+               /// The MixedPrecision, HalfAngle, AdaptiveSeries and HyperDualSeries modes evaluate the
+               /// series through ai(), bi() and ci(), or use their coefficients or thresholds
+               template < typename, CalculationMode, class > friend class TrigonometricCoeffsImpl;
+               /// IncrementalCoeffs uses the c_i threshold, beyond which its sin and cos are used directly
+               template < typename, class > friend class rodrigues_formula::IncrementalCoeffs;
+
+               static constexpr T S_ONE = 1.0;
+               static constexpr long double S_THRESHOLD = 0.25L;
+               /// The direct c_i expressions cancel much more than the a_i and b_i ones
+               static constexpr long double S_C_THRESHOLD = 1.0L;
+               typedef TrigonometricCoeffsImpl<T, CalculationMode::Direct, Policy> DirectImpl;
+
+               /// Terms of the a_i, b_i and c_i series, enough for the precision of T up to the thresholds
+               static const unsigned N_A_TERMS = series_terms(0, 0.0625L, std::numeric_limits<T>::digits);
+               static const unsigned N_B_TERMS = series_terms(1, 0.0625L, std::numeric_limits<T>::digits);
+               static const unsigned N_C_TERMS = series_terms(2, 1.0L, std::numeric_limits<T>::digits);
+               static const unsigned N_MAX_TERMS =
+                    N_A_TERMS > N_B_TERMS ? (N_A_TERMS > N_C_TERMS ? N_A_TERMS : N_C_TERMS)
+                                          : (N_B_TERMS > N_C_TERMS ? N_B_TERMS : N_C_TERMS);
+
+               typedef std::array<std::array<T, N_MAX_TERMS>, 9> SeriesCoefficients;
+               /// Coefficients in theta^2 of each series, [3 * level + i][term]
+               static const SeriesCoefficients S_SERIES;
+
+               /**
+                * @brief Series coefficients, (-1)^j P_k(j) / (2j + i)! for the term j >= k of level k
+                * (see series_coefficient()). The inverse factorials are computed in T, which avoids
+                * the overflow of integer factorials past 20! for the long series of the wide types.
+                */
+               static SeriesCoefficients series_coefficients() {
+                    const unsigned n_factorials = 2 * (2 + N_MAX_TERMS) + 2;
+                    std::vector<T> inv_factorial(n_factorials);
+                    inv_factorial[0] = S_ONE;
+                    for (unsigned n = 1; n < n_factorials; ++n)
+                    {
+                         inv_factorial[n] = inv_factorial[n - 1] / T(n);
+                    }
+                    SeriesCoefficients c;
+                    for (unsigned k = 0; k < 3; ++k)
+                    {
+                         for (unsigned i = 0; i < 3; ++i)
+                         {
+                              for (unsigned t = 0; t < N_MAX_TERMS; ++t)
+                              {
+                                   const unsigned j = t + k;
+                                   T p = (j % 2) ? -S_ONE : S_ONE;
+                                   for (unsigned m = 0; m < k; ++m) p *= T(2 * j - 2 * m);
+                                   c[3 * k + i][t] = p * inv_factorial[2 * j + i];
+                              }
+                         }
+                    }
+                    return c;
+               }
+
+               /**
+                * @brief Horner evaluation in theta^2 of the first N_TERMS terms of the level K series
+                */
+               template < unsigned K, unsigned N_TERMS > static T series(unsigned int i, T theta) {
+                    assert(i < 3);
+                    const T u = theta * theta;
+                    const std::array<T, N_MAX_TERMS> &c = S_SERIES[3 * K + i];
+                    T res = c[N_TERMS - 1];
+                    for (unsigned int t = N_TERMS - 1; t-- > 0; )
+                    {
+                         res = res * u + c[t];
+                    }
+                    return res;
+               }
+
+               static T ai(unsigned int i, T theta) {
+                    return series<0, N_A_TERMS>(i, theta);
+               }
+
+               static T bi(unsigned int i, T theta) {
+                    return series<1, N_B_TERMS>(i, theta);
+               }
+
+               static T ci(unsigned int i, T theta) {
+                    return series<2, N_C_TERMS>(i, theta);
+               }
+
+               /**
+                * @brief a1 .. c2 below the threshold, one series after the other
+                */
+               static void series_bundle(T theta, CoefficientBundle<T> &r, std::false_type) {
+                    r.a1 = ai(1, theta);
+                    r.a2 = ai(2, theta);
+                    r.b0 = bi(0, theta);
+                    r.b1 = bi(1, theta);
+                    r.b2 = bi(2, theta);
+                    r.c0 = ci(0, theta);
+                    r.c1 = ci(1, theta);
+                    r.c2 = ci(2, theta);
+               }
+
+               static void series_bundle(T theta, CoefficientBundle<T> &r, std::true_type) {
+                    HorizontalSeries::bundle(theta, r);
+               }
+
+               static const bool HAS_LANES = !std::is_void<typename SeriesLanes<T>::type>::value &&
+                    Policy::horizontal_series();
+
+               /**
+                * @brief a1 .. c2 below the threshold, with the eight series side by side in the
+                * lanes of vector polynomials in theta^2, for the latency-bound single theta case.
+                *
+                * Eight scalar Horner chains already overlap in the pipeline, so the lanes alone do
+                * not shorten the critical path; they pay for Estrin's scheme instead, whose extra
+                * multiply-adds run in parallel: 1 + ceil(log2(N_MAX_TERMS - 1)) dependent steps
+                * rather than N_MAX_TERMS. The last step is a Horner one, c_0 + u E(u), so that the
+                * rounding errors of the Estrin pairs are scaled down by u (alone they double the
+                * error). The a_i and b_i lanes take N_MAX_TERMS terms too, which only adds
+                * negligible ones.
+                */
+               struct HorizontalSeries
+               {
+                    typedef typename SeriesLanes<T>::type Lanes;
+                    static const unsigned LANES = sizeof(Lanes) / sizeof(T);
+                    static const unsigned NV = 8 / LANES;
+                    static const unsigned N_TAIL = N_MAX_TERMS - 1;
+                    /// S_SERIES rows 1 .. 8 (a1 .. c2) transposed: lane k of the term t is [t][k / LANES][k % LANES]
+                    typedef std::array<std::array<Lanes, NV>, N_MAX_TERMS> LaneCoefficients;
+
+                    static void bundle(T theta, CoefficientBundle<T> &r) {
+                         const LaneCoefficients &c = lane_coefficients();
+                         const Lanes u = Lanes() + theta * theta;
+                         // Estrin on the terms 1 .. N_MAX_TERMS - 1
+                         Lanes x = u;
+                         Lanes p[(N_TAIL + 1) / 2][NV];
+                         for (unsigned j = 0; j < N_TAIL / 2; ++j)
+                         {
+                              for (unsigned v = 0; v < NV; ++v) p[j][v] = c[1 + 2 * j][v] + c[2 + 2 * j][v] * x;
+                         }
+                         if (N_TAIL % 2)
+                         {
+                              for (unsigned v = 0; v < NV; ++v) p[N_TAIL / 2][v] = c[N_TAIL][v];
+                         }
+                         for (unsigned n = (N_TAIL + 1) / 2; n > 1; n = (n + 1) / 2)
+                         {
+                              x *= x;
+                              for (unsigned j = 0; j < n / 2; ++j)
+                              {
+                                   for (unsigned v = 0; v < NV; ++v) p[j][v] = p[2 * j][v] + p[2 * j + 1][v] * x;
+                              }
+                              if (n % 2)
+                              {
+                                   for (unsigned v = 0; v < NV; ++v) p[n / 2][v] = p[n - 1][v];
+                              }
+                         }
+                         T res[8];
+                         for (unsigned v = 0; v < NV; ++v)
+                         {
+                              const Lanes e = c[0][v] + p[0][v] * u;
+                              for (unsigned k = 0; k < LANES; ++k) res[v * LANES + k] = e[k];
+                         }
+                         r.a1 = res[0];
+                         r.a2 = res[1];
+                         r.b0 = res[2];
+                         r.b1 = res[3];
+                         r.b2 = res[4];
+                         r.c0 = res[5];
+                         r.c1 = res[6];
+                         r.c2 = res[7];
+                    }
+
+                    static const LaneCoefficients &lane_coefficients() {
+                         static const LaneCoefficients s_lanes = transpose(series_coefficients());
+                         return s_lanes;
+                    }
+
+                    static LaneCoefficients transpose(const SeriesCoefficients &series) {
+                         LaneCoefficients l;
+                         for (unsigned t = 0; t < N_MAX_TERMS; ++t)
+                         {
+                              for (unsigned k = 0; k < 8; ++k) l[t][k / LANES][k % LANES] = series[k + 1][t];
+                         }
+                         return l;
+                    }
+               };
+          };
+
+          template <typename T, class Policy> constexpr T
+          TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion, Policy>::S_ONE;
+          template <typename T, class Policy> constexpr long double
+          TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion, Policy>::S_THRESHOLD;
+          template <typename T, class Policy> constexpr long double
+          TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion, Policy>::S_C_THRESHOLD;
+
+          template <typename T, class Policy>
+          const typename TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion, Policy>::SeriesCoefficients
+          TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion, Policy>::S_SERIES =
+               TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion, Policy>::series_coefficients();
+
+          /**
+           * @brief Lookup table with cubic Hermite interpolation in theta^2 (see CoefficientTable).
+           *
+           * The table covers |theta| < Policy::table_theta_max and is built on first use; outside of
+           * it the series/direct implementation is used. Derivatives follow from the tabulated b_i
+           * and c_i: da_i = theta b_i, d2a_i = b_i + theta^2 c_i.
+           */
+          template <typename T, class Policy>
+          class TrigonometricCoeffsImpl<T, CalculationMode::Table, Policy>
+          {
+          public:
+               typedef typename Policy::Math Math;
+               typedef TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion, Policy> FallbackImpl;
+
+               static const CoefficientTable<T> &table() {
+                    static const CoefficientTable<T> s_table(Policy::template table_theta_max<T>(),
+                                                             Policy::template table_tolerance<T>());
+                    return s_table;
+               }
+
+               /// Whether theta needs the fallback, never when the range hint is within the table
+               static bool outside(const CoefficientTable<T> &t, T theta) {
+                    return !within_range<Policy>(Policy::template table_theta_max<T>()) && !t.contains(theta);
+               }
+
+#define RODRIGUES_TABLE_COEFFICIENT(member, idx)                        \
+               static T member(T theta) {                               \
+                    const CoefficientTable<T> &t = table();             \
+                    if (outside(t, theta))                              \
+                    {                                                   \
+                         RODRIGUES_COUNT(TableFallback);                \
+                         return FallbackImpl::member(theta);            \
+                    }                                                   \
+                    return t.eval(idx, theta);                          \
+               }
+
+               RODRIGUES_TABLE_COEFFICIENT(a0, 0)
+               RODRIGUES_TABLE_COEFFICIENT(a1, 1)
+               RODRIGUES_TABLE_COEFFICIENT(a2, 2)
+               RODRIGUES_TABLE_COEFFICIENT(b0, 3)
+               RODRIGUES_TABLE_COEFFICIENT(b1, 4)
+               RODRIGUES_TABLE_COEFFICIENT(b2, 5)
+               RODRIGUES_TABLE_COEFFICIENT(c0, 6)
+               RODRIGUES_TABLE_COEFFICIENT(c1, 7)
+               RODRIGUES_TABLE_COEFFICIENT(c2, 8)
+
+#undef RODRIGUES_TABLE_COEFFICIENT
+
+               static T da0(T theta) { return theta * b0(theta); }
+               static T da1(T theta) { return theta * b1(theta); }
+               static T da2(T theta) { return theta * b2(theta); }
+               static T d2a0(T theta) { return b0(theta) + theta * theta * c0(theta); }
+               static T d2a1(T theta) { return b1(theta) + theta * theta * c1(theta); }
+               static T d2a2(T theta) { return b2(theta) + theta * theta * c2(theta); }
+
+               static CoefficientBundle<T> bundle(T theta) {
+                    const CoefficientTable<T> &t = table();
+                    if (outside(t, theta))
+                    {
+                         RODRIGUES_COUNT(TableFallback);
+                         return FallbackImpl::bundle(theta);
+                    }
+                    T v[CoefficientTable<T>::N_COEFFS];
+                    t.eval_all(theta, v);
+                    CoefficientBundle<T> r = { v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8] };
+                    return r;
+               }
+          };
+
+          /**
+           * @brief Next wider floating point type, used by the MixedPrecision mode. Types with no
+           * wider hardware type (long double, DoubleDouble, __float128) map to themselves, and
+           * the mode then evaluates everything in T.
+           */
+          template < typename T > struct WiderType { typedef T type; };
+          template <> struct WiderType<float> { typedef double type; };
+          template <> struct WiderType<double> { typedef long double type; };
+
+          /**
+           * @brief Inputs and outputs in T, cancellation-prone sub-expressions in the wider type W.
+           *
+           * Near 0 the series are evaluated in T, as they do not cancel. Beyond the series
+           * thresholds, a2, b1, b2 and the c_i, whose direct expressions subtract nearly equal
+           * terms, are evaluated in W and rounded once to T; the single coefficient functions
+           * evaluate cos(theta) and sin(theta) / theta (a0, a1 and b0) in T. bundle() makes a
+           * single sincos in W and rounds every coefficient from it, except the c_i, which keep
+           * their series up to S_C_THRESHOLD. With T = float this keeps the storage and bandwidth
+           * of float with close to correctly rounded results.
+           */
+          template <typename T, class Policy>
+          class TrigonometricCoeffsImpl<T, CalculationMode::MixedPrecision, Policy>
+          {
+          public:
+               typedef typename Policy::Math Math;
+               typedef typename WiderType<T>::type W;
+               static_assert(std::numeric_limits<W>::digits >= std::numeric_limits<T>::digits,
+                             "The wider type must not be narrower than T");
+
+               static T a0(T theta) {
+                    return Math::cos(theta);
+               }
+
+               static T a1(T theta) {
+                    if (beyond<Policy>(theta, S_THRESHOLD))
+                    {
+                         RODRIGUES_COUNT(MixedDirectTaken);
+                         return Math::sin(theta) / theta;
+                    }
+                    RODRIGUES_COUNT(MixedSeriesTaken);
+                    return SeriesImpl::ai(1, theta);
+               }
+
+               static T b0(T theta) {
+                    if (beyond<Policy>(theta, S_THRESHOLD))
+                    {
+                         RODRIGUES_COUNT(MixedDirectTaken);
+                         return -Math::sin(theta) / theta;
+                    }
+                    RODRIGUES_COUNT(MixedSeriesTaken);
+                    return SeriesImpl::bi(0, theta);
+               }
+
+#define RODRIGUES_MIXED_COEFFICIENT(member, threshold, level, i)        \
+               static T member(T theta) {                               \
+                    if (beyond<Policy>(theta, threshold))               \
+                    {                                                   \
+                         RODRIGUES_COUNT(MixedDirectTaken);             \
+                         return static_cast<T>(WideImpl::member(W(theta))); \
+                    }                                                   \
+                    RODRIGUES_COUNT(MixedSeriesTaken);                  \
+                    return SeriesImpl::level(i, theta);                 \
+               }
+
+               RODRIGUES_MIXED_COEFFICIENT(a2, S_THRESHOLD, ai, 2)
+               RODRIGUES_MIXED_COEFFICIENT(b1, S_THRESHOLD, bi, 1)
+               RODRIGUES_MIXED_COEFFICIENT(b2, S_THRESHOLD, bi, 2)
+               RODRIGUES_MIXED_COEFFICIENT(c0, S_C_THRESHOLD, ci, 0)
+               RODRIGUES_MIXED_COEFFICIENT(c1, S_C_THRESHOLD, ci, 1)
+               RODRIGUES_MIXED_COEFFICIENT(c2, S_C_THRESHOLD, ci, 2)
+
+#undef RODRIGUES_MIXED_COEFFICIENT
+
+               static CoefficientBundle<T> bundle(T theta) {
+                    if (!beyond<Policy>(theta, S_THRESHOLD)) return generic_bundle<TrigonometricCoeffsImpl>(theta);
+                    const W wide_theta(theta);
+                    W s, c;
+                    Math::sincos(wide_theta, s, c);
+                    const CoefficientBundle<W> w = WideImpl::bundle(wide_theta, s, c);
+                    CoefficientBundle<T> r = {
+                         static_cast<T>(w.a0), static_cast<T>(w.a1), static_cast<T>(w.a2),
+                         static_cast<T>(w.b0), static_cast<T>(w.b1), static_cast<T>(w.b2),
+                         static_cast<T>(w.c0), static_cast<T>(w.c1), static_cast<T>(w.c2)
+                    };
+                    if (beyond<Policy>(theta, S_C_THRESHOLD))
+                    {
+                         RODRIGUES_COUNT_N(MixedDirectTaken, 8);
+                         return r;
+                    }
+                    RODRIGUES_COUNT_N(MixedDirectTaken, 5);
+                    RODRIGUES_COUNT_N(MixedSeriesTaken, 3);
+                    r.c0 = SeriesImpl::ci(0, theta);
+                    r.c1 = SeriesImpl::ci(1, theta);
+                    r.c2 = SeriesImpl::ci(2, theta);
+                    return r;
+               }
+
+          protected:
+               static constexpr long double S_THRESHOLD = 0.25L;
+               static constexpr long double S_C_THRESHOLD = 1.0L;
+               typedef TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion, Policy> SeriesImpl;
+               typedef TrigonometricCoeffsImpl<W, CalculationMode::Direct, Policy> WideImpl;
+          };
+
+          template <typename T, class Policy> constexpr long double
+          TrigonometricCoeffsImpl<T, CalculationMode::MixedPrecision, Policy>::S_THRESHOLD;
+          template <typename T, class Policy> constexpr long double
+          TrigonometricCoeffsImpl<T, CalculationMode::MixedPrecision, Policy>::S_C_THRESHOLD;
+
+          /**
+           * @brief Coefficients of theta from those of the half angle h = theta / 2, with a single
+           * sin / cos evaluation of h.
+           *
+           * With the level 1 functions of h, A = a1(h) = sin(h) / h, B = b1(h) and C = c1(h),
+           * and cos(h), the double angle identities give
+           *
+           *   a1 = A cos(h)                 a2 = A^2 / 2
+           *   b1 = (B cos(h) - A^2) / 4     b2 = A B / 4
+           *   c1 = (C cos(h) - 3 A B) / 16  c2 = (B^2 + A C) / 16
+           *
+           * and b0 = -a1, c0 = -b1. Every term of the sums has the same sign as long as cos(h) > 0,
+           * i.e. |theta| < pi, so unlike the direct expressions nothing cancels there: a1 and a2
+           * are accurate everywhere without a branch. B and C themselves are differences of nearly
+           * equal terms at small h, so they come from their series up to |h| = 1 (|theta| = 2),
+           * where the direct expressions of h lose at most a couple of bits.
+           *
+           * a0 = 1 - 2 sin^2(h) and a0 = 2 cos^2(h) - 1 lose their relative accuracy around the
+           * zeros of cos(theta). a0() is cos(theta), as in the other modes; bundle() uses the first
+           * for |theta| <= 0.3 pi and the second for 0.7 pi <= |theta| <= 1.3 pi, within about
+           * 1.2 ulp, and only calls cos(theta) in between.
+           */
+          template <typename T, class Policy>
+          class TrigonometricCoeffsImpl<T, CalculationMode::HalfAngle, Policy>
+          {
+          public:
+               typedef typename Policy::Math Math;
+               static T a0(T theta) {
+                    return Math::cos(theta);
+               }
+
+               static T a1(T theta) {
+                    const T h = theta / T(2);
+                    T s, c;
+                    Math::sincos(h, s, c);
+                    return sinc(h, s) * c;
+               }
+
+               static T a2(T theta) {
+                    const T h = theta / T(2);
+                    const T a = sinc(h, Math::sin(h));
+                    return a * a / T(2);
+               }
+
+               static T b0(T theta) {
+                    return -a1(theta);
+               }
+
+               static T b1(T theta) {
+                    const T h = theta / T(2);
+                    T s, c;
+                    Math::sincos(h, s, c);
+                    const T a = sinc(h, s);
+                    return (half_b1(h, s, c) * c - a * a) / T(4);
+               }
+
+               static T b2(T theta) {
+                    const T h = theta / T(2);
+                    T s, c;
+                    Math::sincos(h, s, c);
+                    return sinc(h, s) * half_b1(h, s, c) / T(4);
+               }
+
+               static T c0(T theta) {
+                    return -b1(theta);
+               }
+
+               static T c1(T theta) {
+                    const T h = theta / T(2);
+                    T s, c;
+                    Math::sincos(h, s, c);
+                    return (half_c1(h, s, c) * c - T(3) * sinc(h, s) * half_b1(h, s, c)) / T(16);
+               }
+
+               static T c2(T theta) {
+                    const T h = theta / T(2);
+                    T s, c;
+                    Math::sincos(h, s, c);
+                    const T b = half_b1(h, s, c);
+                    return (b * b + sinc(h, s) * half_c1(h, s, c)) / T(16);
+               }
+
+               static T da0(T theta) { return theta * b0(theta); }
+               static T da1(T theta) { return theta * b1(theta); }
+               static T da2(T theta) { return theta * b2(theta); }
+               static T d2a0(T theta) { return b0(theta) + theta * theta * c0(theta); }
+               static T d2a1(T theta) { return b1(theta) + theta * theta * c1(theta); }
+               static T d2a2(T theta) { return b2(theta) + theta * theta * c2(theta); }
+
+               static CoefficientBundle<T> bundle(T theta) {
+                    const T h = theta / T(2);
+                    T s, c;
+                    Math::sincos(h, s, c);
+                    const T a = sinc(h, s), b = half_b1(h, s, c), cc = half_c1(h, s, c);
+                    CoefficientBundle<T> r;
+                    r.a0 = half_a0(theta, s, c);
+                    r.a1 = a * c;
+                    r.a2 = a * a / T(2);
+                    r.b0 = -r.a1;
+                    r.b1 = (b * c - a * a) / T(4);
+                    r.b2 = a * b / T(4);
+                    r.c0 = -r.b1;
+                    r.c1 = (cc * c - T(3) * a * b) / T(16);
+                    r.c2 = (b * b + a * cc) / T(16);
+                    return r;
+               }
+
+          protected:
+               static constexpr long double S_THRESHOLD = 1.0L;
+               /// |theta| up to which a0 = 1 - 2 sin^2(h), 0.3 pi
+               static constexpr long double S_A0_SIN_LIMIT = 0.942477796076937971538793014983850865L;
+               /// |theta| range of a0 = 2 cos^2(h) - 1, [0.7 pi, 1.3 pi]
+               static constexpr long double S_A0_COS_MIN = 2.199114857512855266923850368295652019L;
+               static constexpr long double S_A0_COS_MAX = 4.084070449666731210001436398263353749L;
+               typedef TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion, Policy> SeriesImpl;
+
+               /// Terms of the b1 series up to |h| = 1, more than SeriesImpl::N_B_TERMS
+               static const unsigned N_B_TERMS = series_terms(1, 1.0L, std::numeric_limits<T>::digits);
+               typedef std::array<T, N_B_TERMS> B1Coefficients;
+               /// Coefficients in h^2 of the b1 series, longer than the SeriesImpl one
+               static const B1Coefficients S_B1_SERIES;
+
+               /**
+                * @brief (-1)^j 2j / (2j + 1)! for the term j = t + 1, as the level 1, i = 1 row of
+                * SeriesImpl::series_coefficients()
+                */
+               static B1Coefficients b1_coefficients() {
+                    B1Coefficients c;
+                    T inv_factorial = T(1) / T(6);
+                    for (unsigned t = 0; t < N_B_TERMS; ++t)
+                    {
+                         const unsigned j = t + 1;
+                         if (t > 0) inv_factorial /= T(2 * j) * T(2 * j + 1);
+                         c[t] = (j % 2) ? -T(2 * j) * inv_factorial : T(2 * j) * inv_factorial;
+                    }
+                    return c;
+               }
+
+               /// Horner evaluation in h^2 of the b1 series
+               static T b1_series(T h) {
+                    const T u = h * h;
+                    T res = S_B1_SERIES[N_B_TERMS - 1];
+                    for (unsigned int t = N_B_TERMS - 1; t-- > 0; )
+                    {
+                         res = res * u + S_B1_SERIES[t];
+                    }
+                    return res;
+               }
+
+               /// sin(h) / h, correctly rounded sin(h) divided by the exact h except at 0
+               static T sinc(T h, T s) {
+                    return h == T(0) ? T(1) : s / h;
+               }
+
+               /// cos(theta) from s = sin(h) and c = cos(h) away from the zeros of cos(theta)
+               static T half_a0(T theta, T s, T c) {
+                    if (!beyond<Policy>(theta, S_A0_SIN_LIMIT)) return T(1) - T(2) * s * s;
+                    if (beyond<Policy>(theta, S_A0_COS_MIN) && !beyond<Policy>(theta, S_A0_COS_MAX))
+                    {
+                         return T(2) * c * c - T(1);
+                    }
+                    return Math::cos(theta);
+               }
+
+               static T half_b1(T h, T s, T c) {
+                    if (!within_range<Policy>(2 * S_THRESHOLD) && fabs(h) > T(S_THRESHOLD))
+                    {
+                         RODRIGUES_COUNT(HalfAngleDirectTaken);
+                         return (h * c - s) / (h * h * h);
+                    }
+                    RODRIGUES_COUNT(HalfAngleSeriesTaken);
+                    return b1_series(h);
+               }
+
+               static T half_c1(T h, T s, T c) {
+                    if (!within_range<Policy>(2 * S_THRESHOLD) && fabs(h) > T(S_THRESHOLD))
+                    {
+                         RODRIGUES_COUNT(HalfAngleDirectTaken);
+                         const T h2 = h * h;
+                         return (T(3) * s - T(3) * h * c - h2 * s) / (h2 * h2 * h);
+                    }
+                    RODRIGUES_COUNT(HalfAngleSeriesTaken);
+                    return SeriesImpl::ci(1, h);
+               }
+          };
+
+          template <typename T, class Policy> constexpr long double
+          TrigonometricCoeffsImpl<T, CalculationMode::HalfAngle, Policy>::S_THRESHOLD;
+          template <typename T, class Policy> constexpr long double
+          TrigonometricCoeffsImpl<T, CalculationMode::HalfAngle, Policy>::S_A0_SIN_LIMIT;
+          template <typename T, class Policy> constexpr long double
+          TrigonometricCoeffsImpl<T, CalculationMode::HalfAngle, Policy>::S_A0_COS_MIN;
+          template <typename T, class Policy> constexpr long double
+          TrigonometricCoeffsImpl<T, CalculationMode::HalfAngle, Policy>::S_A0_COS_MAX;
+
+          template <typename T, class Policy>
+          const typename TrigonometricCoeffsImpl<T, CalculationMode::HalfAngle, Policy>::B1Coefficients
+          TrigonometricCoeffsImpl<T, CalculationMode::HalfAngle, Policy>::S_B1_SERIES =
+               TrigonometricCoeffsImpl<T, CalculationMode::HalfAngle, Policy>::b1_coefficients();
+
+          /**
+           * @brief SeriesExpansion with as many series terms as |theta| needs: the SeriesExpansion
+           * lengths are set by the thresholds, but at |theta| = 1e-4 the second or third term is
+           * already below the precision of double.
+           *
+           * n terms of the level k series are enough while the first dropped term, |s_n| u^n with
+           * u = theta^2, stays below 2^-(digits + 3) of the first one, two bits tighter than the
+           * criterion of series_terms() so that the truncation stays below the rounding of the sum.
+           * The largest such u for every n is precomputed per T, and each evaluation scans it from
+           * n = 1.
+           */
+          template <typename T, class Policy>
+          class TrigonometricCoeffsImpl<T, CalculationMode::AdaptiveSeries, Policy>
+          {
+          public:
+               typedef typename Policy::Math Math;
+               static T a0(T theta) {
+                    return Math::cos(theta);
+               }
+
+#define RODRIGUES_ADAPTIVE_COEFFICIENT(member, threshold, level, i)     \
+               static T member(T theta) {                               \
+                    if (beyond<Policy>(theta, SeriesImpl::threshold))   \
+                    {                                                   \
+                         RODRIGUES_COUNT(AdaptiveDirectTaken);          \
+                         return DirectImpl::member(theta);              \
+                    }                                                   \
+                    RODRIGUES_COUNT(AdaptiveSeriesTaken);               \
+                    const T u = theta * theta;                          \
+                    return series<level>(i, u, n_terms<level>(u));      \
+               }
+
+               RODRIGUES_ADAPTIVE_COEFFICIENT(a1, S_THRESHOLD, 0, 1)
+               RODRIGUES_ADAPTIVE_COEFFICIENT(a2, S_THRESHOLD, 0, 2)
+               RODRIGUES_ADAPTIVE_COEFFICIENT(b0, S_THRESHOLD, 1, 0)
+               RODRIGUES_ADAPTIVE_COEFFICIENT(b1, S_THRESHOLD, 1, 1)
+               RODRIGUES_ADAPTIVE_COEFFICIENT(b2, S_THRESHOLD, 1, 2)
+               RODRIGUES_ADAPTIVE_COEFFICIENT(c0, S_C_THRESHOLD, 2, 0)
+               RODRIGUES_ADAPTIVE_COEFFICIENT(c1, S_C_THRESHOLD, 2, 1)
+               RODRIGUES_ADAPTIVE_COEFFICIENT(c2, S_C_THRESHOLD, 2, 2)
+
+#undef RODRIGUES_ADAPTIVE_COEFFICIENT
+
+               static T da0(T theta) { return theta * b0(theta); }
+               static T da1(T theta) { return theta * b1(theta); }
+               static T da2(T theta) { return theta * b2(theta); }
+               static T d2a0(T theta) { return b0(theta) + theta * theta * c0(theta); }
+               static T d2a1(T theta) { return b1(theta) + theta * theta * c1(theta); }
+               static T d2a2(T theta) { return b2(theta) + theta * theta * c2(theta); }
+
+               static CoefficientBundle<T> bundle(T theta) {
+                    if (beyond<Policy>(theta, SeriesImpl::S_THRESHOLD))
+                    {
+                         T s, c;
+                         Math::sincos(theta, s, c);
+                         return bundle(theta, s, c);
+                    }
+                    return bundle(theta, T(0), Math::cos(theta));
+               }
+
+               /**
+                * @brief All the coefficients from already known s = sin(theta) and c = cos(theta);
+                * s is only used beyond the series threshold
+                */
+               static CoefficientBundle<T> bundle(T theta, T s, T c) {
+                    if (beyond<Policy>(theta, SeriesImpl::S_C_THRESHOLD))
+                    {
+                         RODRIGUES_COUNT_N(AdaptiveDirectTaken, 8);
+                         return DirectImpl::bundle(theta, s, c);
+                    }
+                    const T u = theta * theta;
+                    CoefficientBundle<T> r;
+                    if (beyond<Policy>(theta, SeriesImpl::S_THRESHOLD))
+                    {
+                         RODRIGUES_COUNT_N(AdaptiveDirectTaken, 5);
+                         RODRIGUES_COUNT_N(AdaptiveSeriesTaken, 3);
+                         r = DirectImpl::bundle(theta, s, c);
+                    }
+                    else
+                    {
+                         RODRIGUES_COUNT_N(AdaptiveSeriesTaken, 8);
+                         const unsigned na = n_terms<0>(u), nb = n_terms<1>(u);
+                         r.a0 = c;
+                         r.a1 = series<0>(1, u, na);
+                         r.a2 = series<0>(2, u, na);
+                         r.b0 = series<1>(0, u, nb);
+                         r.b1 = series<1>(1, u, nb);
+                         r.b2 = series<1>(2, u, nb);
+                    }
+                    const unsigned nc = n_terms<2>(u);
+                    r.c0 = series<2>(0, u, nc);
+                    r.c1 = series<2>(1, u, nc);
+                    r.c2 = series<2>(2, u, nc);
+                    return r;
+               }
+
+          protected:
+               typedef TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion, Policy> SeriesImpl;
+               typedef TrigonometricCoeffsImpl<T, CalculationMode::Direct, Policy> DirectImpl;
+
+               static const unsigned N_MAX_TERMS = SeriesImpl::N_MAX_TERMS;
+               typedef std::array<std::array<T, N_MAX_TERMS>, 3> TermLimits;
+               /// Largest theta^2 for which n terms of the level k series are enough, [k][n - 1]
+               static const TermLimits S_TERM_LIMITS;
+
+               static TermLimits term_limits() {
+                    const long double eps = std::ldexp(1.0L, -std::numeric_limits<T>::digits - 3);
+                    // Not S_SERIES, whose dynamic initialization may come after this one
+                    const typename SeriesImpl::SeriesCoefficients series = SeriesImpl::series_coefficients();
+                    TermLimits l;
+                    for (unsigned k = 0; k < 3; ++k)
+                    {
+                         // i = 0 has the largest term ratios, which bound those of i = 1, 2
+                         const std::array<T, N_MAX_TERMS> &c = series[3 * k];
+                         const long double first = std::fabs(static_cast<long double>(c[0]));
+                         for (unsigned n = 1; n < N_MAX_TERMS; ++n)
+                         {
+                              const long double next = std::fabs(static_cast<long double>(c[n]));
+                              l[k][n - 1] = T(std::pow(eps * first / next, 1.0L / n));
+                         }
+                         l[k][N_MAX_TERMS - 1] = T(std::numeric_limits<long double>::infinity());
+                    }
+                    return l;
+               }
+
+               /**
+                * @brief Terms of the level K series needed at u = theta^2, at most the
+                * SeriesExpansion length (reached at the threshold)
+                */
+               template < unsigned K > static unsigned n_terms(T u) {
+                    const unsigned n_max = K == 0 ? SeriesImpl::N_A_TERMS : (K == 1 ? SeriesImpl::N_B_TERMS : SeriesImpl::N_C_TERMS);
+                    const std::array<T, N_MAX_TERMS> &l = S_TERM_LIMITS[K];
+                    unsigned n = 1;
+                    while (n < n_max && u > l[n - 1]) ++n;
+                    RODRIGUES_COUNT_N(AdaptiveSeriesTerms, n);
+                    return n;
+               }
+
+               /**
+                * @brief Horner evaluation in u = theta^2 of the first n terms of the level K series
+                */
+               template < unsigned K > static T series(unsigned int i, T u, unsigned n) {
+                    assert(i < 3 && n >= 1 && n <= N_MAX_TERMS);
+                    return series<K>(i, u, n, std::integral_constant<unsigned, N_MAX_TERMS>());
+               }
+
+               /// Dispatch to the fixed length Horner loops, which the compiler unrolls
+               template < unsigned K, unsigned N >
+               static T series(unsigned int i, T u, unsigned n, std::integral_constant<unsigned, N>) {
+                    if (n == N) return horner<K, N>(i, u);
+                    return series<K>(i, u, n, std::integral_constant<unsigned, N - 1>());
+               }
+
+               template < unsigned K > static T series(unsigned int i, T u, unsigned, std::integral_constant<unsigned, 1>) {
+                    return horner<K, 1>(i, u);
+               }
+
+               template < unsigned K, unsigned N > static T horner(unsigned int i, T u) {
+                    const std::array<T, N_MAX_TERMS> &c = SeriesImpl::S_SERIES[3 * K + i];
+                    T res = c[N - 1];
+                    for (unsigned int t = N - 1; t-- > 0; )
+                    {
+                         res = res * u + c[t];
+                    }
+                    return res;
+               }
+          };
+
+          template <typename T, class Policy>
+          const typename TrigonometricCoeffsImpl<T, CalculationMode::AdaptiveSeries, Policy>::TermLimits
+          TrigonometricCoeffsImpl<T, CalculationMode::AdaptiveSeries, Policy>::S_TERM_LIMITS =
+               TrigonometricCoeffsImpl<T, CalculationMode::AdaptiveSeries, Policy>::term_limits();
+
+          /**
+           * @brief All the coefficients from the a_i series alone, evaluated in hyper-dual numbers.
+           *
+           * With u = theta^2 and a_i = A_i(u), the chain rule gives b_i = 2 A_i'(u) and
+           * c_i = 4 A_i''(u): the A_i series evaluated at u + e1 + e2 return them in their e1 and
+           * e1e2 parts. Unlike the NumericHyperDual mode, which differentiates the direct
+           * expressions in theta, nothing cancels and nothing is divided by theta, so the b_i, c_i
+           * and the derivatives keep the accuracy of the series down to theta = 0, without the
+           * hand-derived level 1 and 2 series. Any other function given by a series in theta^2
+           * can be differentiated the same way.
+           *
+           * The series cover the SeriesExpansion c_i range, |theta| <= 1, with N_C_TERMS + 2
+           * terms so that A_i'' is as long as the c_i series; beyond, the direct expressions are
+           * used.
+           */
+          template <typename T, class Policy>
+          class TrigonometricCoeffsImpl<T, CalculationMode::HyperDualSeries, Policy>
+          {
+          public:
+               typedef typename Policy::Math Math;
+
+#define RODRIGUES_HYPERDUAL_SERIES_COEFFICIENT(member, i, expr)         \
+               static T member(T theta) {                               \
+                    if (beyond<Policy>(theta, SeriesImpl::S_C_THRESHOLD)) \
+                    {                                                   \
+                         RODRIGUES_COUNT(HyperDualDirectTaken);         \
+                         return DirectImpl::member(theta);              \
+                    }                                                   \
+                    RODRIGUES_COUNT(HyperDualSeriesTaken);              \
+                    Hyperdual<T> d = derivatives(i, theta);             \
+                    return expr;                                        \
+               }
+
+               RODRIGUES_HYPERDUAL_SERIES_COEFFICIENT(b0, 0, T(2) * d.eps1())
+               RODRIGUES_HYPERDUAL_SERIES_COEFFICIENT(b1, 1, T(2) * d.eps1())
+               RODRIGUES_HYPERDUAL_SERIES_COEFFICIENT(b2, 2, T(2) * d.eps1())
+               RODRIGUES_HYPERDUAL_SERIES_COEFFICIENT(c0, 0, T(4) * d.eps1eps2())
+               RODRIGUES_HYPERDUAL_SERIES_COEFFICIENT(c1, 1, T(4) * d.eps1eps2())
+               RODRIGUES_HYPERDUAL_SERIES_COEFFICIENT(c2, 2, T(4) * d.eps1eps2())
+               RODRIGUES_HYPERDUAL_SERIES_COEFFICIENT(da0, 0, T(2) * theta * d.eps1())
+               RODRIGUES_HYPERDUAL_SERIES_COEFFICIENT(da1, 1, T(2) * theta * d.eps1())
+               RODRIGUES_HYPERDUAL_SERIES_COEFFICIENT(da2, 2, T(2) * theta * d.eps1())
+               RODRIGUES_HYPERDUAL_SERIES_COEFFICIENT(d2a0, 0, T(2) * d.eps1() + T(4) * theta * theta * d.eps1eps2())
+               RODRIGUES_HYPERDUAL_SERIES_COEFFICIENT(d2a1, 1, T(2) * d.eps1() + T(4) * theta * theta * d.eps1eps2())
+               RODRIGUES_HYPERDUAL_SERIES_COEFFICIENT(d2a2, 2, T(2) * d.eps1() + T(4) * theta * theta * d.eps1eps2())
+
+#undef RODRIGUES_HYPERDUAL_SERIES_COEFFICIENT
+
+               /// The a_i need no derivative: the same series, in T
+               static T a0(T theta) {
+                    if (beyond<Policy>(theta, SeriesImpl::S_C_THRESHOLD))
+                    {
+                         RODRIGUES_COUNT(HyperDualDirectTaken);
+                         return DirectImpl::a0(theta);
+                    }
+                    RODRIGUES_COUNT(HyperDualSeriesTaken);
+                    return series(0, theta * theta);
+               }
+
+               static T a1(T theta) {
+                    if (beyond<Policy>(theta, SeriesImpl::S_C_THRESHOLD))
+                    {
+                         RODRIGUES_COUNT(HyperDualDirectTaken);
+                         return DirectImpl::a1(theta);
+                    }
+                    RODRIGUES_COUNT(HyperDualSeriesTaken);
+                    return series(1, theta * theta);
+               }
+
+               static T a2(T theta) {
+                    if (beyond<Policy>(theta, SeriesImpl::S_C_THRESHOLD))
+                    {
+                         RODRIGUES_COUNT(HyperDualDirectTaken);
+                         return DirectImpl::a2(theta);
+                    }
+                    RODRIGUES_COUNT(HyperDualSeriesTaken);
+                    return series(2, theta * theta);
+               }
+
+               static CoefficientBundle<T> bundle(T theta) {
+                    if (beyond<Policy>(theta, SeriesImpl::S_C_THRESHOLD))
+                    {
+                         T s, c;
+                         Math::sincos(theta, s, c);
+                         return bundle(theta, s, c);
+                    }
+                    return bundle(theta, T(0), T(1));
+               }
+
+               /**
+                * @brief All the coefficients from already known s = sin(theta) and c = cos(theta);
+                * they are only used beyond the series threshold
+                */
+               static CoefficientBundle<T> bundle(T theta, T s, T c) {
+                    if (beyond<Policy>(theta, SeriesImpl::S_C_THRESHOLD))
+                    {
+                         RODRIGUES_COUNT_N(HyperDualDirectTaken, 9);
+                         return DirectImpl::bundle(theta, s, c);
+                    }
+                    RODRIGUES_COUNT_N(HyperDualSeriesTaken, 9);
+                    const Hyperdual<T> u(theta * theta, T(1), T(1), T(0));
+                    Hyperdual<T> d0 = series(0, u), d1 = series(1, u), d2 = series(2, u);
+                    CoefficientBundle<T> r;
+                    r.a0 = d0.real();
+                    r.a1 = d1.real();
+                    r.a2 = d2.real();
+                    r.b0 = T(2) * d0.eps1();
+                    r.b1 = T(2) * d1.eps1();
+                    r.b2 = T(2) * d2.eps1();
+                    r.c0 = T(4) * d0.eps1eps2();
+                    r.c1 = T(4) * d1.eps1eps2();
+                    r.c2 = T(4) * d2.eps1eps2();
+                    return r;
+               }
+
+          protected:
+               typedef TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion, Policy> SeriesImpl;
+               typedef TrigonometricCoeffsImpl<T, CalculationMode::Direct, Policy> DirectImpl;
+
+               static const unsigned N_TERMS = SeriesImpl::N_C_TERMS + 2;
+               typedef std::array<std::array<T, N_TERMS>, 3> SeriesCoefficients;
+               /// Coefficients in theta^2 of the a_i series, [i][term]
+               static const SeriesCoefficients S_SERIES;
+
+               /**
+                * @brief (-1)^j / (2j + i)!, as the level 0 of SeriesImpl::series_coefficients(),
+                * with the two more terms that the second derivative consumes
+                */
+               static SeriesCoefficients series_coefficients() {
+                    SeriesCoefficients c;
+                    for (unsigned i = 0; i < 3; ++i)
+                    {
+                         T inv_factorial(1);
+                         for (unsigned n = 2; n <= i; ++n) inv_factorial /= T(n);
+                         for (unsigned j = 0; j < N_TERMS; ++j)
+                         {
+                              if (j > 0) inv_factorial /= T(2 * j + i - 1) * T(2 * j + i);
+                              c[i][j] = (j % 2) ? -inv_factorial : inv_factorial;
+                         }
+                    }
+                    return c;
+               }
+
+               /**
+                * @brief Horner evaluation of the A_i series at u, in any number type built from T
+                */
+               template < typename U > static U series(unsigned int i, const U &u) {
+                    assert(i < 3);
+                    const std::array<T, N_TERMS> &c = S_SERIES[i];
+                    U res(c[N_TERMS - 1]);
+                    for (unsigned int t = N_TERMS - 1; t-- > 0; )
+                    {
+                         res = res * u + c[t];
+                    }
+                    return res;
+               }
+
+               /// A_i(u), A_i'(u) and A_i''(u) at u = theta^2, in the real, e1 and e1e2 parts
+               static Hyperdual<T> derivatives(unsigned int i, T theta) {
+                    return series(i, Hyperdual<T>(theta * theta, T(1), T(1), T(0)));
+               }
+          };
+
+          template <typename T, class Policy>
+          const typename TrigonometricCoeffsImpl<T, CalculationMode::HyperDualSeries, Policy>::SeriesCoefficients
+          TrigonometricCoeffsImpl<T, CalculationMode::HyperDualSeries, Policy>::S_SERIES =
+               TrigonometricCoeffsImpl<T, CalculationMode::HyperDualSeries, Policy>::series_coefficients();
+
+     }
+
+}
+
+#endif
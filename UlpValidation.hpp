@@ -0,0 +1,371 @@
+#ifndef _ulp_validation_h
+#define _ulp_validation_h
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "NarrowFloat.hpp"
+#include "StreamingPipeline.hpp"
+#include "TrigonometricCoeffs.hpp"
+#include "WorkStealingScheduler.hpp"
+
+namespace rodrigues_formula
+{
+
+     /**
+      * @brief Distance between value and ref, in units in the last place of T at ref
+      *
+      * References beyond the range of T are measured with the ulp of the largest finite T.
+      */
+     template < typename T, typename Ref >
+     Ref ulp_error(T value, Ref ref)
+     {
+          // Only arithmetic on Ref, so that extended types (DoubleDouble, __float128) can be used
+          T r = std::fabs(static_cast<T>(ref));
+          if (!(r <= std::numeric_limits<T>::max())) r = std::numeric_limits<T>::max();
+          r = std::max(r, std::numeric_limits<T>::min());
+          const Ref ulp = static_cast<Ref>(std::ldexp(1.0L, std::ilogb(r) - (std::numeric_limits<T>::digits - 1)));
+          const Ref diff = static_cast<Ref>(value) - ref;
+          return (diff < 0 ? -diff : diff) / ulp;
+     }
+
+     /**
+      * @brief Same, in ulps of a format with the given number of significant digits, exponent of
+      * the smallest normal number and largest finite value (e.g. a 16-bit storage format)
+      */
+     template < typename Ref >
+     Ref ulp_error(long double value, Ref ref, int digits, int min_exponent, long double max)
+     {
+          long double r = std::fabs(static_cast<long double>(ref));
+          if (!(r <= max)) r = max;
+          const int e = r > 0 ? std::max(std::ilogb(r), min_exponent) : min_exponent;
+          const Ref ulp = static_cast<Ref>(std::ldexp(1.0L, e - (digits - 1)));
+          const Ref diff = static_cast<Ref>(value) - ref;
+          return (diff < 0 ? -diff : diff) / ulp;
+     }
+
+     /**
+      * @brief Accuracy validation of the coefficients computed in T against a reference computed in
+      * the wider type Ref.
+      *
+      * Every registered technique is evaluated for every finite point of the sweep and compared to
+      * the reference, which is computed only once per point with the series/direct implementation
+      * in Ref at |theta| (all the coefficients are even functions). The points are processed in
+      * blocks: each technique evaluates one coefficient over the whole block before moving to the
+      * next one, so the inner loops are plain array loops the compiler can vectorize. Blocks are
+      * distributed over the threads with the work-stealing scheduler.
+      *
+      * Typical use is an exhaustive sweep over all the float bit patterns, which gives hard
+      * worst-case ULP bounds.
+      *
+      * With set_storage<Narrow>() the values are rounded to a 16-bit storage format (see
+      * NarrowFloat.hpp) before the comparison and the errors are measured in ulps of that format,
+      * i.e. the accuracy of the stored results.
+      *
+      * run_streaming() processes the same blocks through a StreamingPipeline instead, with point
+      * generation, evaluation and error reduction overlapped on different threads and memory
+      * bounded by the few blocks in flight.
+      */
+     template < typename T, typename Ref = long double > class UlpValidation
+     {
+     public:
+          static const std::size_t N_COEFFS = 6;
+
+          typedef std::function<void(const T *theta, std::size_t n, T *const out[N_COEFFS])> BatchEvaluator;
+
+          struct CoefficientStats
+          {
+               Ref max_ulp = 0;
+               T worst_theta = 0;
+               T worst_value = 0;
+               Ref worst_reference = 0;
+               Ref sum_ulp = 0;
+               std::uint64_t n_points = 0;
+               /// Non-finite values produced where the reference is finite
+               std::uint64_t n_nonfinite = 0;
+               T nonfinite_theta = 0;
+
+               void merge(const CoefficientStats &o) {
+                    if (o.max_ulp > max_ulp || (n_points == 0 && o.n_points))
+                    {
+                         max_ulp = o.max_ulp;
+                         worst_theta = o.worst_theta;
+                         worst_value = o.worst_value;
+                         worst_reference = o.worst_reference;
+                    }
+                    if (n_nonfinite == 0 && o.n_nonfinite) nonfinite_theta = o.nonfinite_theta;
+                    sum_ulp += o.sum_ulp;
+                    n_points += o.n_points;
+                    n_nonfinite += o.n_nonfinite;
+               }
+          };
+
+          typedef std::array<CoefficientStats, N_COEFFS> TechniqueStats;
+
+          static const char *coefficient_name(std::size_t i) {
+               static const char *const NAMES[N_COEFFS] = { "a0", "a1", "a2", "b0", "b1", "b2" };
+               return NAMES[i];
+          }
+
+          /**
+           * @brief Registers a TrigonometricCoeffs instance
+           */
+          template < class Coeffs >
+          void add_technique(const std::string &name, const Coeffs &tcs) {
+               m_names.push_back(name);
+               m_techniques.push_back([tcs](const T *x, std::size_t n, T *const out[N_COEFFS]) {
+                         for (std::size_t i = 0; i < n; ++i) out[0][i] = tcs.a0(x[i]);
+                         for (std::size_t i = 0; i < n; ++i) out[1][i] = tcs.a1(x[i]);
+                         for (std::size_t i = 0; i < n; ++i) out[2][i] = tcs.a2(x[i]);
+                         for (std::size_t i = 0; i < n; ++i) out[3][i] = tcs.b0(x[i]);
+                         for (std::size_t i = 0; i < n; ++i) out[4][i] = tcs.b1(x[i]);
+                         for (std::size_t i = 0; i < n; ++i) out[5][i] = tcs.b2(x[i]);
+                    });
+          }
+
+          /**
+           * @brief Measures the values as stored in the Narrow format instead of T = float
+           */
+          template < class Narrow > void set_storage() {
+               static_assert(std::is_same<T, float>::value, "Storage formats are rounded from float");
+               m_storage = Narrow::name();
+               m_round = &round_to<Narrow>;
+               m_digits = Narrow::DIGITS;
+               m_min_exponent = Narrow::MIN_EXPONENT;
+               m_max = Narrow::max();
+          }
+
+          /**
+           * @brief Validates all the techniques over the points point(0) ... point(n_points - 1).
+           * Non-finite points are skipped.
+           */
+          template < class PointFn >
+          void run(WorkStealingScheduler &scheduler, std::uint64_t n_points, PointFn point) {
+               m_stats.assign(m_techniques.size(), TechniqueStats());
+               m_n_skipped = 0;
+               scheduler.parallel_for(n_points, [&](std::size_t begin, std::size_t end) {
+                         process(begin, end, point);
+                    });
+          }
+
+          /**
+           * @brief Same as run(), as a generate -> evaluate -> reduce pipeline over chunks of
+           * chunk_size points. Memory use is O(chunk_size * n_evaluators).
+           */
+          template < class PointFn >
+          void run_streaming(unsigned n_evaluators, std::uint64_t n_points, PointFn point,
+                             std::size_t chunk_size = 1024) {
+               m_stats.assign(m_techniques.size(), TechniqueStats());
+               m_n_skipped = 0;
+
+               StreamingPipeline<Chunk> pipeline(n_evaluators);
+               std::vector<Chunk> pool(2 * pipeline.evaluators() + 2);
+               for (auto &c : pool)
+               {
+                    c.x.resize(chunk_size);
+                    c.values.resize(m_techniques.size() * N_COEFFS * chunk_size);
+                    c.refs.resize(N_COEFFS * chunk_size);
+               }
+
+               std::uint64_t k = 0;
+               pipeline.run(pool,
+                            [&](Chunk &c) {
+                                 c.n = 0;
+                                 for (; k < n_points && c.n < chunk_size; ++k)
+                                 {
+                                      const T v = point(k);
+                                      if (std::isfinite(v)) c.x[c.n++] = v;
+                                      else ++m_n_skipped;
+                                 }
+                                 return c.n != 0;
+                            },
+                            [&](Chunk &c) {
+                                 Ref *ref[N_COEFFS];
+                                 for (std::size_t i = 0; i < N_COEFFS; ++i) ref[i] = &c.refs[i * chunk_size];
+                                 reference(c.x.data(), c.n, ref);
+                                 for (std::size_t t = 0; t < m_techniques.size(); ++t)
+                                 {
+                                      T *out[N_COEFFS];
+                                      for (std::size_t i = 0; i < N_COEFFS; ++i) out[i] = &c.values[(t * N_COEFFS + i) * chunk_size];
+                                      m_techniques[t](c.x.data(), c.n, out);
+                                      round(out, c.n);
+                                 }
+                            },
+                            [&](Chunk &c) {
+                                 for (std::size_t t = 0; t < m_techniques.size(); ++t)
+                                 {
+                                      for (std::size_t i = 0; i < N_COEFFS; ++i)
+                                      {
+                                           accumulate(m_stats[t][i], c.x.data(), &c.values[(t * N_COEFFS + i) * chunk_size],
+                                                      &c.refs[i * chunk_size], c.n);
+                                      }
+                                 }
+                            });
+          }
+
+          const std::vector<TechniqueStats> &stats() const {
+               return m_stats;
+          }
+
+          void report(std::ostream &out) const {
+               out << std::scientific << std::setprecision(7);
+               out << std::setw(12) << "technique" << std::setw(5) << "coef"
+                   << std::setw(16) << "max ulp" << std::setw(16) << "mean ulp"
+                   << std::setw(16) << "worst theta" << std::setw(16) << "value"
+                   << std::setw(16) << "reference" << std::setw(12) << "non-finite"
+                   << std::setw(16) << "e.g. theta" << "\n";
+               for (std::size_t t = 0; t < m_stats.size(); ++t)
+               {
+                    for (std::size_t c = 0; c < N_COEFFS; ++c)
+                    {
+                         const CoefficientStats &s = m_stats[t][c];
+                         const std::uint64_t n_finite = s.n_points - s.n_nonfinite;
+                         out << std::setw(12) << m_names[t] << std::setw(5) << coefficient_name(c)
+                             << std::setw(16) << static_cast<double>(s.max_ulp)
+                             << std::setw(16) << (n_finite ? static_cast<double>(s.sum_ulp / n_finite) : 0.)
+                             << std::setw(16) << s.worst_theta
+                             << std::setw(16) << s.worst_value
+                             << std::setw(16) << static_cast<double>(s.worst_reference)
+                             << std::setw(12) << s.n_nonfinite;
+                         if (s.n_nonfinite) out << std::setw(16) << s.nonfinite_theta;
+                         out << "\n";
+                    }
+               }
+               if (!m_stats.empty())
+               {
+                    out << m_stats[0][0].n_points << " points evaluated, " << m_n_skipped << " non-finite points skipped\n";
+               }
+               if (!m_storage.empty())
+               {
+                    out << "Values rounded to " << m_storage << ", errors in ulps of " << m_storage << "\n";
+               }
+          }
+
+          /**
+           * @brief Reference values, computed in Ref
+           */
+          static void reference(const T *theta, std::size_t n, Ref *const out[N_COEFFS]) {
+               typedef detail::TrigonometricCoeffsImpl<Ref, CalculationMode::SeriesExpansion> RefImpl;
+               for (std::size_t i = 0; i < n; ++i)
+               {
+                    const Ref x = static_cast<Ref>(std::fabs(theta[i]));
+                    out[0][i] = RefImpl::a0(x);
+                    out[1][i] = RefImpl::a1(x);
+                    out[2][i] = RefImpl::a2(x);
+                    out[3][i] = RefImpl::b0(x);
+                    out[4][i] = RefImpl::b1(x);
+                    out[5][i] = RefImpl::b2(x);
+               }
+          }
+
+     protected:
+          static const std::size_t BLOCK = 256;
+
+          struct Chunk
+          {
+               std::size_t n = 0;
+               std::vector<T> x;
+               /// technique-major, then coefficient-major
+               std::vector<T> values;
+               std::vector<Ref> refs;
+          };
+
+          std::vector<std::string> m_names;
+          std::vector<BatchEvaluator> m_techniques;
+          std::vector<TechniqueStats> m_stats;
+          std::uint64_t m_n_skipped = 0;
+          /// Storage format of the values, if not T
+          std::string m_storage;
+          void (*m_round)(float *, std::size_t) = nullptr;
+          int m_digits = std::numeric_limits<T>::digits;
+          int m_min_exponent = std::numeric_limits<T>::min_exponent - 1;
+          long double m_max = std::numeric_limits<T>::max();
+          std::mutex m_mutex;
+
+          template < class PointFn >
+          void process(std::size_t begin, std::size_t end, PointFn &point) {
+               std::vector<TechniqueStats> local(m_techniques.size());
+               std::vector<T> x(BLOCK), values(N_COEFFS * BLOCK);
+               std::vector<Ref> refs(N_COEFFS * BLOCK);
+               T *out[N_COEFFS];
+               Ref *ref[N_COEFFS];
+               for (std::size_t c = 0; c < N_COEFFS; ++c)
+               {
+                    out[c] = &values[c * BLOCK];
+                    ref[c] = &refs[c * BLOCK];
+               }
+               std::uint64_t skipped = 0;
+
+               std::size_t k = begin;
+               while (k < end)
+               {
+                    std::size_t n = 0;
+                    for (; k < end && n < BLOCK; ++k)
+                    {
+                         const T v = point(k);
+                         if (std::isfinite(v)) x[n++] = v;
+                         else ++skipped;
+                    }
+                    reference(x.data(), n, ref);
+                    for (std::size_t t = 0; t < m_techniques.size(); ++t)
+                    {
+                         m_techniques[t](x.data(), n, out);
+                         round(out, n);
+                         for (std::size_t c = 0; c < N_COEFFS; ++c)
+                         {
+                              accumulate(local[t][c], x.data(), out[c], ref[c], n);
+                         }
+                    }
+               }
+
+               std::lock_guard<std::mutex> lock(m_mutex);
+               m_n_skipped += skipped;
+               for (std::size_t t = 0; t < local.size(); ++t)
+               {
+                    for (std::size_t c = 0; c < N_COEFFS; ++c)
+                    {
+                         m_stats[t][c].merge(local[t][c]);
+                    }
+               }
+          }
+
+          void round(T *const out[N_COEFFS], std::size_t n) const {
+               if (!m_round) return;
+               for (std::size_t c = 0; c < N_COEFFS; ++c) m_round(reinterpret_cast<float *>(out[c]), n);
+          }
+
+          void accumulate(CoefficientStats &s, const T *x, const T *value, const Ref *ref, std::size_t n) const {
+               for (std::size_t i = 0; i < n; ++i)
+               {
+                    if (!std::isfinite(value[i]))
+                    {
+                         if (s.n_nonfinite++ == 0) s.nonfinite_theta = x[i];
+                         continue;
+                    }
+                    const Ref err = m_storage.empty() ? ulp_error(value[i], ref[i])
+                         : ulp_error(value[i], ref[i], m_digits, m_min_exponent, m_max);
+                    s.sum_ulp += err;
+                    if (err > s.max_ulp)
+                    {
+                         s.max_ulp = err;
+                         s.worst_theta = x[i];
+                         s.worst_value = value[i];
+                         s.worst_reference = ref[i];
+                    }
+               }
+               s.n_points += n;
+          }
+     };
+
+}
+
+#endif
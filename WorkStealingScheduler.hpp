@@ -0,0 +1,346 @@
+#ifndef _work_stealing_scheduler_h
+#define _work_stealing_scheduler_h
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rodrigues_formula
+{
+
+     /**
+      * @brief Work-stealing scheduler for index-range jobs with heterogeneous per-item costs.
+      *
+      * Each job processes the index range [0, size) through a body called on sub-ranges. Jobs are
+      * initially split evenly among the workers' deques. A worker pops ranges from the bottom of its
+      * own deque and, when it runs dry, steals from the top of another worker's deque. Ranges are
+      * lazily halved until they fit the chunk granularity of their job, which is derived from the
+      * measured per-item cost of that job so that every executed chunk takes roughly
+      * target_chunk_ns. Cheap jobs (e.g. series evaluation near 0) thus get large chunks, while
+      * expensive ones (e.g. hyper-dual evaluation) get small ones that keep all cores busy.
+      *
+      * The calling thread takes part in the execution as worker 0. Workers that find every deque
+      * empty sleep until a range is published or the run completes, instead of spinning while a
+      * last long chunk executes.
+      */
+     class WorkStealingScheduler
+     {
+     public:
+          struct Job
+          {
+               /// Processes items [begin, end)
+               std::function<void(std::size_t, std::size_t)> body;
+               std::size_t size;
+          };
+
+          struct JobStats
+          {
+               std::size_t chunks = 0;
+               std::size_t steals = 0;
+               double seconds = 0.;     ///< Accumulated execution time, over all workers
+               double ns_per_item = 0.; ///< Final per-item cost estimate
+          };
+
+          explicit WorkStealingScheduler(unsigned n_workers = std::thread::hardware_concurrency(),
+                                         double target_chunk_ns = 50e3) :
+               m_n_workers(std::max(1u, n_workers)),
+               m_target_chunk_ns(target_chunk_ns),
+               m_workers(m_n_workers),
+               m_generation(0),
+               m_stop(false)
+          {
+               for (unsigned w = 1; w < m_n_workers; ++w)
+               {
+                    m_threads.emplace_back(&WorkStealingScheduler::thread_main, this, w);
+               }
+          }
+
+          ~WorkStealingScheduler() {
+               {
+                    std::lock_guard<std::mutex> lock(m_batch_mutex);
+                    m_stop = true;
+               }
+               m_batch_cv.notify_all();
+               for (auto &t : m_threads)
+               {
+                    t.join();
+               }
+          }
+
+          WorkStealingScheduler(const WorkStealingScheduler &) = delete;
+          WorkStealingScheduler &operator=(const WorkStealingScheduler &) = delete;
+
+          unsigned workers() const {
+               return m_n_workers;
+          }
+
+          /**
+           * @brief Runs all the jobs to completion. Blocks the caller, which also executes chunks.
+           *
+           * If any body throws, the remaining chunks are drained without being executed and the
+           * first exception is rethrown here.
+           */
+          std::vector<JobStats> run(const std::vector<Job> &jobs) {
+               std::vector<JobState> states(jobs.size());
+               std::size_t total = 0;
+               for (std::size_t j = 0; j < jobs.size(); ++j)
+               {
+                    states[j].job = &jobs[j];
+                    total += jobs[j].size;
+               }
+               if (total == 0)
+               {
+                    return std::vector<JobStats>(jobs.size());
+               }
+
+               for (std::size_t j = 0; j < jobs.size(); ++j)
+               {
+                    const std::size_t n = jobs[j].size;
+                    for (unsigned w = 0; w < m_n_workers; ++w)
+                    {
+                         const std::size_t begin = n * w / m_n_workers;
+                         const std::size_t end = n * (w + 1) / m_n_workers;
+                         if (begin < end) m_workers[w].tasks.push_back(Range{ j, begin, end });
+                    }
+               }
+
+               m_states = &states;
+               m_remaining.store(total);
+               m_error = nullptr;
+               m_failed.store(false);
+               {
+                    std::lock_guard<std::mutex> lock(m_batch_mutex);
+                    ++m_generation;
+                    m_active = m_n_workers - 1;
+               }
+               m_batch_cv.notify_all();
+
+               work(0);
+
+               {
+                    std::unique_lock<std::mutex> lock(m_batch_mutex);
+                    m_done_cv.wait(lock, [this] { return m_active == 0; });
+               }
+               m_states = nullptr;
+               if (m_error)
+               {
+                    std::rethrow_exception(m_error);
+               }
+
+               std::vector<JobStats> stats(jobs.size());
+               for (std::size_t j = 0; j < jobs.size(); ++j)
+               {
+                    stats[j].chunks = states[j].chunks.load();
+                    stats[j].steals = states[j].steals.load();
+                    stats[j].seconds = states[j].busy_ns.load() * 1e-9;
+                    stats[j].ns_per_item = states[j].ns_per_item.load();
+               }
+               return stats;
+          }
+
+          /**
+           * @brief Convenience wrapper running a single job over [0, n)
+           */
+          void parallel_for(std::size_t n, std::function<void(std::size_t, std::size_t)> body) {
+               run(std::vector<Job>{ Job{ std::move(body), n } });
+          }
+
+     protected:
+          struct Range
+          {
+               std::size_t job, begin, end;
+          };
+
+          struct JobState
+          {
+               const Job *job = nullptr;
+               /// Per-item cost estimate. 0 means "not measured yet"
+               std::atomic<double> ns_per_item{ 0. };
+               std::atomic<std::size_t> chunks{ 0 };
+               std::atomic<std::size_t> steals{ 0 };
+               std::atomic<unsigned long long> busy_ns{ 0 };
+          };
+
+          struct Worker
+          {
+               std::mutex mutex;
+               std::deque<Range> tasks;
+          };
+
+          /// Smallest chunk used before the cost of a job has been measured
+          static const std::size_t FIRST_CHUNK = 16;
+
+          unsigned m_n_workers;
+          double m_target_chunk_ns;
+          std::vector<Worker> m_workers;
+          std::vector<std::thread> m_threads;
+
+          std::mutex m_batch_mutex;
+          std::condition_variable m_batch_cv, m_done_cv;
+          unsigned long m_generation;
+          unsigned m_active = 0;
+          bool m_stop;
+
+          /// Idle workers, woken when ranges are published or the last item is done
+          std::mutex m_idle_mutex;
+          std::condition_variable m_idle_cv;
+          std::atomic<unsigned> m_idle{ 0 };
+          std::atomic<unsigned long> m_published{ 0 };
+
+          std::vector<JobState> *m_states = nullptr;
+          std::atomic<std::size_t> m_remaining{ 0 };
+          std::atomic<bool> m_failed{ false };
+          std::mutex m_error_mutex;
+          std::exception_ptr m_error;
+
+          void thread_main(unsigned w) {
+               unsigned long seen = 0;
+               for (;;)
+               {
+                    {
+                         std::unique_lock<std::mutex> lock(m_batch_mutex);
+                         m_batch_cv.wait(lock, [&] { return m_stop || m_generation != seen; });
+                         if (m_stop) return;
+                         seen = m_generation;
+                    }
+                    work(w);
+                    {
+                         std::lock_guard<std::mutex> lock(m_batch_mutex);
+                         --m_active;
+                    }
+                    m_done_cv.notify_one();
+               }
+          }
+
+          bool pop(unsigned w, Range &r) {
+               std::lock_guard<std::mutex> lock(m_workers[w].mutex);
+               if (m_workers[w].tasks.empty()) return false;
+               r = m_workers[w].tasks.back();
+               m_workers[w].tasks.pop_back();
+               return true;
+          }
+
+          bool steal(unsigned thief, Range &r) {
+               for (unsigned k = 1; k < m_n_workers; ++k)
+               {
+                    const unsigned victim = (thief + k) % m_n_workers;
+                    std::lock_guard<std::mutex> lock(m_workers[victim].mutex);
+                    if (!m_workers[victim].tasks.empty())
+                    {
+                         r = m_workers[victim].tasks.front();
+                         m_workers[victim].tasks.pop_front();
+                         return true;
+                    }
+               }
+               return false;
+          }
+
+          std::size_t grain(const JobState &state) const {
+               const double cost = state.ns_per_item.load(std::memory_order_relaxed);
+               if (cost <= 0.) return FIRST_CHUNK;
+               return std::max<std::size_t>(1, static_cast<std::size_t>(m_target_chunk_ns / cost));
+          }
+
+          void work(unsigned w) {
+               typedef std::chrono::steady_clock Clock;
+               std::vector<JobState> &states = *m_states;
+               Range r;
+               while (m_remaining.load() != 0)
+               {
+                    if (!pop(w, r))
+                    {
+                         const unsigned long published = m_published.load();
+                         if (!steal(w, r))
+                         {
+                              wait_for_work(published);
+                              continue;
+                         }
+                         states[r.job].steals.fetch_add(1, std::memory_order_relaxed);
+                    }
+
+                    JobState &state = states[r.job];
+                    // Lazy binary splitting: publish the upper halves so that idle workers can take them
+                    const std::size_t g = grain(state);
+                    bool split = false;
+                    while (r.end - r.begin > 2 * g)
+                    {
+                         const std::size_t mid = r.begin + (r.end - r.begin) / 2;
+                         {
+                              std::lock_guard<std::mutex> lock(m_workers[w].mutex);
+                              m_workers[w].tasks.push_back(Range{ r.job, mid, r.end });
+                         }
+                         r.end = mid;
+                         split = true;
+                    }
+                    if (split)
+                    {
+                         m_published.fetch_add(1);
+                         wake_idle();
+                    }
+
+                    const std::size_t n = r.end - r.begin;
+                    if (!m_failed.load(std::memory_order_relaxed))
+                    {
+                         const auto t0 = Clock::now();
+                         try
+                         {
+                              state.job->body(r.begin, r.end);
+                         }
+                         catch (...)
+                         {
+                              std::lock_guard<std::mutex> lock(m_error_mutex);
+                              if (!m_error) m_error = std::current_exception();
+                              m_failed.store(true);
+                         }
+                         const double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+                         update_cost(state, ns / n);
+                         state.busy_ns.fetch_add(static_cast<unsigned long long>(ns), std::memory_order_relaxed);
+                         state.chunks.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    if (m_remaining.fetch_sub(n) == n) wake_idle();
+               }
+          }
+
+          /**
+           * @brief Sleeps until ranges are published after the given count, or all the items are
+           * done. m_idle is raised before the checks and m_published after the pushes, both
+           * sequentially consistent, so either the sleeper sees the new ranges or the publisher
+           * sees the sleeper and notifies it under the mutex.
+           */
+          void wait_for_work(unsigned long published) {
+               std::unique_lock<std::mutex> lock(m_idle_mutex);
+               m_idle.fetch_add(1);
+               m_idle_cv.wait(lock, [&] { return m_remaining.load() == 0 || m_published.load() != published; });
+               m_idle.fetch_sub(1);
+          }
+
+          void wake_idle() {
+               if (m_idle.load() == 0) return;
+               {
+                    std::lock_guard<std::mutex> lock(m_idle_mutex);
+               }
+               m_idle_cv.notify_all();
+          }
+
+          /**
+           * @brief Exponentially weighted moving average of the per-item cost. Races between
+           * workers only lose samples, which is harmless for a granularity estimate.
+           */
+          static void update_cost(JobState &state, double sample) {
+               const double old = state.ns_per_item.load(std::memory_order_relaxed);
+               const double updated = old <= 0. ? sample : 0.75 * old + 0.25 * sample;
+               state.ns_per_item.store(updated, std::memory_order_relaxed);
+          }
+     };
+
+}
+
+#endif
@@ -1,550 +1,747 @@
 #include <algorithm>
-#include <cassert>
+#include <chrono>
 #include <cmath>
-#include <functional>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
-#include "Hyperdual.hpp"
+#include <unistd.h>
+#include "CoefficientRegistry.hpp"
+#include "ColumnarWriter.hpp"
+#include "DoubleDouble.hpp"
+#include "IncrementalCoeffs.hpp"
+#include "MemoizedCoeffs.hpp"
+#include "NarrowFloat.hpp"
+#include "ResultSink.hpp"
+#include "TrigonometricCoeffs.hpp"
+#include "UlpValidation.hpp"
+#include "WorkStealingScheduler.hpp"
 
-/**
- * @brief Compile-time factorial calculation
- */
-constexpr unsigned long int factorial(unsigned long int n)
-{
-     return n <= 1 ? 1 : (n * factorial(n - 1));
-}
+namespace rf = rodrigues_formula;
 
-/**
- * @brief Namespace with the implementation of Ritto-Correa's Rodrigue's formula coefficients using
- * different numerical methods.
- *
- * b_i = \frac{1}{\theta} \diff{a_i(\theta)}{\theta}
- * c_i = \frac{1}{\theta} \diff{b_i(\theta)}{\theta}
- */
-namespace rodrigues_formula
+namespace
 {
+     /**
+      * @brief Command line options of the evaluation driver
+      */
+     struct Options
+     {
+          double step = 1e-2;
+          long n_eval_pts = 101;
+          unsigned n_threads = std::thread::hardware_concurrency();
+          bool verbose = false;
+          enum class Format { Text, Binary } format = Format::Text;
+          std::string output = "-";
+          enum class Sweep { Linear, AllFloats } sweep = Sweep::Linear;
+          enum class Storage { Float, Half, BFloat16 } storage = Storage::Float;
+          std::string store;
+          bool validate = false;
+          enum class Reference { LongDouble, DoubleDouble, Float128 } reference = Reference::LongDouble;
+          bool stream = false;
+          std::size_t chunk = 1024;
+          bool benchmark = false;
+          bool memoize = false;
+          bool incremental = false;
+     };
 
-     enum class CalculationMode { Direct, NumericHyperDual, SeriesExpansion };
-
-     namespace detail
+     void usage(const char *prog)
      {
-          template < typename T, CalculationMode mode >
-          class DependentFalse : std::false_type
-          { };
+          std::cerr << "Usage: " << prog << " [options]\n"
+                    << "  --points N    Number of evaluation points, centered around 0 (default 101)\n"
+                    << "  --step S      Distance between evaluation points (default 1e-2)\n"
+                    << "  --threads N   Number of worker threads (default: hardware concurrency)\n"
+                    << "  --verbose     Print per-job scheduling statistics to stderr\n"
+                    << "  --format F    Output format: text (default) or binary (columnar, see ColumnarWriter.hpp)\n"
+                    << "  --output P    Output file (default: stdout)\n"
+                    << "  --sweep S     Evaluation points: linear (default, see --points and --step) or\n"
+                    << "                all-floats (every float bit pattern, 2^32 points)\n"
+                    << "  --storage S   Storage format of the results: float (default), half or bfloat16.\n"
+                    << "                Values are computed in float and rounded when stored; with --validate\n"
+                    << "                the errors of the stored values are reported in ulps of the format\n"
+                    << "  --store DIR   Stream the results into one memory-mapped file per column in DIR\n"
+                    << "                instead of keeping them in memory and printing them; the results\n"
+                    << "                use the --storage format, the evaluation points are kept in float\n"
+                    << "  --validate    Instead of printing the values, report the worst-case ULP error of\n"
+                    << "                every technique and coefficient over the sweep, against a reference (see --reference)\n"
+                    << "  --exhaustive  Same as --validate --sweep all-floats\n"
+                    << "  --reference R Validation reference type: long-double (default), double-double or\n"
+                    << "                float128 (if built with libquadmath)\n"
+                    << "  --stream      Run the validation as a generate -> evaluate -> reduce pipeline with\n"
+                    << "                O(chunk) memory use\n"
+                    << "  --chunk N     Points per pipeline chunk (default 1024)\n"
+                    << "  --benchmark   Time the batch evaluation of all the coefficients with each sin / cos\n"
+                    << "                backend (std, libmvec, poly, bounded-pi) over the sweep, up to 2^20 points\n"
+                    << "  --memoize     Time repeated passes over the sweep (up to 2^20 points), as the iterations\n"
+                    << "                of a solver, with and without MemoizedCoeffs, and print the cache counters\n"
+                    << "  --incremental Converge to every point of the sweep (up to 2^16 points) from theta + step\n"
+                    << "                by halving steps with IncrementalCoeffs, and report the worst-case ULP errors\n"
+                    << "                of its coefficients and of fresh evaluations against long double\n";
+     }
 
-          template < typename T, CalculationMode mode > class TrigonometricCoeffsImpl
+     Options parse_options(int argc, char *argv[])
+     {
+          Options opts;
+          for (int i = 1; i < argc; ++i)
           {
-          public:
-               static T a0(T theta) {
-                    static_assert(DependentFalse<T, mode>::value, "no default implementation");
+               const std::string arg(argv[i]);
+               auto value = [&]() -> const char * {
+                    if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+                    return argv[++i];
+               };
+               if (arg == "--points") opts.n_eval_pts = std::stol(value());
+               else if (arg == "--step") opts.step = std::stod(value());
+               else if (arg == "--threads") opts.n_threads = std::stoul(value());
+               else if (arg == "--verbose") opts.verbose = true;
+               else if (arg == "--output") opts.output = value();
+               else if (arg == "--store") opts.store = value();
+               else if (arg == "--validate") opts.validate = true;
+               else if (arg == "--stream") opts.stream = true;
+               else if (arg == "--chunk") opts.chunk = std::stoul(value());
+               else if (arg == "--benchmark") opts.benchmark = true;
+               else if (arg == "--memoize") opts.memoize = true;
+               else if (arg == "--incremental") opts.incremental = true;
+               else if (arg == "--exhaustive")
+               {
+                    opts.validate = true;
+                    opts.sweep = Options::Sweep::AllFloats;
                }
-
-               static T a1(T theta) {
-                    static_assert(DependentFalse<T, mode>::value, "no default implementation");
+               else if (arg == "--sweep")
+               {
+                    const std::string sw(value());
+                    if (sw == "linear") opts.sweep = Options::Sweep::Linear;
+                    else if (sw == "all-floats") opts.sweep = Options::Sweep::AllFloats;
+                    else throw std::invalid_argument("unknown sweep " + sw);
                }
-
-               static T a2(T theta) {
-                    static_assert(DependentFalse<T, mode>::value, "no default implementation");
+               else if (arg == "--reference")
+               {
+                    const std::string r(value());
+                    if (r == "long-double") opts.reference = Options::Reference::LongDouble;
+                    else if (r == "double-double") opts.reference = Options::Reference::DoubleDouble;
+#ifdef RODRIGUES_HAVE_FLOAT128
+                    else if (r == "float128") opts.reference = Options::Reference::Float128;
+#endif
+                    else throw std::invalid_argument("unknown reference " + r);
+               }
+               else if (arg == "--storage")
+               {
+                    const std::string st(value());
+                    if (st == "float") opts.storage = Options::Storage::Float;
+                    else if (st == "half") opts.storage = Options::Storage::Half;
+                    else if (st == "bfloat16") opts.storage = Options::Storage::BFloat16;
+                    else throw std::invalid_argument("unknown storage " + st);
                }
-          };
+               else if (arg == "--format")
+               {
+                    const std::string f(value());
+                    if (f == "text") opts.format = Options::Format::Text;
+                    else if (f == "binary") opts.format = Options::Format::Binary;
+                    else throw std::invalid_argument("unknown format " + f);
+               }
+               else throw std::invalid_argument("unknown option " + arg);
+          }
+          if (opts.n_eval_pts <= 0) throw std::invalid_argument("--points must be positive");
+          if (opts.chunk == 0) throw std::invalid_argument("--chunk must be positive");
+          if (opts.stream && !opts.validate) throw std::invalid_argument("--stream requires --validate or --exhaustive");
+          return opts;
      }
+}
 
+namespace
+{
      /**
-      * @brief Template class with the public interface for the coefficients implementation.
-      * @tparam T The underlying real type to be used (float, double)
-      * @tparam CalculationMode The calculation mode to be used. One of the \ref
-      * CalculationMode enum values.
+      * @brief Calculation policy of the driver: very small hyper-dual steps
       */
-     template < typename T, CalculationMode mode > class TrigonometricCoeffs
+     struct SmallStepsPolicy : rf::DefaultPolicy
      {
-     public:
-          typedef detail::TrigonometricCoeffsImpl<T, mode> Impl;
-     protected:
-          Impl m_impl;
-
-     public:
-          TrigonometricCoeffs() :
-               a0(m_impl), a1(m_impl), a2(m_impl),
-               b0(m_impl), b1(m_impl), b2(m_impl)
-          { }
-
-          Impl &impl() {
-               return m_impl;
-          }
-
-          class A0
-          {
-          public:
-               A0(const TrigonometricCoeffs::Impl &impl) : m_impl(impl) { }
-               T operator()(T theta) const {
-                    return m_impl.a0(theta);
-               }
-
-          protected:
-               const TrigonometricCoeffs::Impl &m_impl;
-          };
-
-          class A1
-          {
-          public:
-               A1(const TrigonometricCoeffs::Impl &impl) : m_impl(impl) { }
-               T operator()(T theta) const {
-                    return m_impl.a1(theta);
-               }
+          template < typename T > static constexpr T hyperdual_h1() { return T(1e-14); }
+          template < typename T > static constexpr T hyperdual_h2() { return T(1e-14); }
+     };
 
-          protected:
-               const TrigonometricCoeffs::Impl &m_impl;
-          };
+     /**
+      * @brief Default policy with another sin / cos backend
+      */
+     template < class M > struct BackendPolicy : rf::DefaultPolicy
+     {
+          typedef M Math;
+     };
 
-          class A2
+     /**
+      * @brief Best of 5 timings of the batch bundle evaluation of TCs, in ns per point. The
+      * results are summed into checksum, so that the evaluation cannot be optimised away.
+      */
+     template < class TCs >
+     double bundle_ns_per_point(const std::vector<typename TCs::RealType> &theta, double &checksum)
+     {
+          std::vector<typename TCs::Bundle> bundles(theta.size());
+          double best = 0;
+          for (int run = 0; run < 5; ++run)
           {
-          public:
-               A2(const TrigonometricCoeffs::Impl &impl) : m_impl(impl) { }
-               T operator()(T theta) const {
-                    return m_impl.a2(theta);
-               }
-
-          protected:
-               const TrigonometricCoeffs::Impl &m_impl;
-          };
+               const auto start = std::chrono::steady_clock::now();
+               TCs::bundle(theta.data(), theta.size(), bundles.data());
+               const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+               const double ns = elapsed.count() / theta.size();
+               if (run == 0 || ns < best) best = ns;
+          }
+          for (const auto &b : bundles) checksum += b.a2 + b.b2 + b.c2;
+          return best;
+     }
 
-          class B0
-          {
-          public:
-               B0(const TrigonometricCoeffs::Impl &impl) : m_impl(impl) { }
-               T operator()(T theta) const {
-                    return m_impl.b0(theta);
-               }
+     /**
+      * @brief Prints the batch bundle timings of a calculation mode with every sin / cos backend;
+      * BoundedPiMath only when the angles are within its range
+      */
+     template < typename T, rf::CalculationMode mode >
+     void benchmark_backends(const std::vector<T> &theta, bool bounded, double &checksum, std::ostream &out)
+     {
+          out << std::setw(18) << rf::mode_name(mode)
+              << std::setw(12) << bundle_ns_per_point<rf::TrigonometricCoeffs<T, mode, BackendPolicy<rf::StdMath>>>(theta, checksum)
+              << std::setw(12) << bundle_ns_per_point<rf::TrigonometricCoeffs<T, mode, BackendPolicy<rf::VectorMath>>>(theta, checksum)
+              << std::setw(12) << bundle_ns_per_point<rf::TrigonometricCoeffs<T, mode, BackendPolicy<rf::PolynomialMath>>>(theta, checksum);
+          if (bounded) out << std::setw(12) << bundle_ns_per_point<rf::TrigonometricCoeffs<T, mode, rf::DefaultPolicy, rf::BoundedPi>>(theta, checksum);
+          else out << std::setw(12) << "-";
+          out << "\n";
+     }
 
-          protected:
-               const TrigonometricCoeffs::Impl &m_impl;
+     /**
+      * @brief Times PASSES passes over theta, split among the scheduler workers, with TCs::bundle
+      * and with its MemoizedCoeffs front-end, as the iterations of a solver whose angles do not
+      * change. Prints the ns per point of both and the counters of the caches.
+      *
+      * An untimed pass first creates the caches of the workers (empty, so the timed passes still
+      * start with misses) and warms up the plain evaluation.
+      */
+     template < class TCs >
+     void memoize_run(rf::WorkStealingScheduler &scheduler, const std::vector<typename TCs::RealType> &theta,
+                      std::ostream &out)
+     {
+          typedef rf::MemoizedCoeffs<TCs> Memo;
+          const unsigned PASSES = 8;
+          std::vector<typename TCs::Bundle> bundles(theta.size());
+          auto time_passes = [&](bool memoized) {
+               const auto start = std::chrono::steady_clock::now();
+               for (unsigned pass = 0; pass < PASSES; ++pass)
+               {
+                    scheduler.parallel_for(theta.size(), [&](std::size_t begin, std::size_t end) {
+                              for (std::size_t k = begin; k < end; ++k)
+                              {
+                                   bundles[k] = memoized ? Memo::get(theta[k]) : TCs::bundle(theta[k]);
+                              }
+                         });
+               }
+               const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+               return elapsed.count() / (PASSES * theta.size());
           };
+          scheduler.parallel_for(theta.size(), [&](std::size_t begin, std::size_t end) {
+                    Memo::clear();
+                    for (std::size_t k = begin; k < end; ++k)
+                    {
+                         bundles[k] = TCs::bundle(theta[k]);
+                    }
+               });
+          const double plain = time_passes(false);
+          const double memoized = time_passes(true);
+          out << std::setw(18) << TCs::name() << std::setw(12) << plain << std::setw(12) << memoized << "   ";
+          Memo::total_stats().report(out);
+     }
 
-          class B1
+     /**
+      * @brief Follows, for every point p of theta, the path of a converging Newton iteration,
+      * p + step 2^-j for j = 0 .. ITERATIONS, with IncrementalCoeffs. Prints the worst-case ULP
+      * error of its coefficients and of fresh SeriesExpansion bundles over all the iterates,
+      * against a long double reference, and the update counters.
+      */
+     template < typename T >
+     void incremental_run(const std::vector<T> &theta, T step, std::ostream &out)
+     {
+          typedef rf::detail::TrigonometricCoeffsImpl<long double, rf::CalculationMode::SeriesExpansion> RefImpl;
+          typedef rf::TrigonometricCoeffs<T, rf::CalculationMode::SeriesExpansion> TCs;
+          const unsigned ITERATIONS = std::numeric_limits<T>::digits;
+          const char *const NAMES[9] = { "a0", "a1", "a2", "b0", "b1", "b2", "c0", "c1", "c2" };
+          long double worst[2][9] = {};
+          typename rf::IncrementalCoeffs<T>::Stats stats;
+          for (const T p : theta)
           {
-          public:
-               B1(const TrigonometricCoeffs::Impl &impl) : m_impl(impl) { }
-               T operator()(T theta) const {
-                    return m_impl.b1(theta);
+               T delta = step;
+               rf::IncrementalCoeffs<T> inc(p + delta);
+               for (unsigned j = 0; j < ITERATIONS; ++j)
+               {
+                    delta /= T(2);
+                    const auto &b = inc.update(-delta);
+                    const auto f = TCs::bundle(inc.theta());
+                    const long double x = inc.theta();
+                    const long double ref[9] = { RefImpl::a0(x), RefImpl::a1(x), RefImpl::a2(x),
+                                                 RefImpl::b0(x), RefImpl::b1(x), RefImpl::b2(x),
+                                                 RefImpl::c0(x), RefImpl::c1(x), RefImpl::c2(x) };
+                    const T values[2][9] = { { b.a0, b.a1, b.a2, b.b0, b.b1, b.b2, b.c0, b.c1, b.c2 },
+                                             { f.a0, f.a1, f.a2, f.b0, f.b1, f.b2, f.c0, f.c1, f.c2 } };
+                    for (unsigned k = 0; k < 2; ++k)
+                    {
+                         for (unsigned i = 0; i < 9; ++i) worst[k][i] = std::max(worst[k][i], rf::ulp_error(values[k][i], ref[i]));
+                    }
                }
-
-          protected:
-               const TrigonometricCoeffs::Impl &m_impl;
-          };
-
-          class B2
+               stats.incremental += inc.stats().incremental;
+               stats.full += inc.stats().full;
+          }
+          out << "Incremental updates converging to " << theta.size() << " points, " << ITERATIONS
+              << " halving steps from theta + " << step << ", max ulp errors\n" << std::setw(12) << "";
+          for (const char *name : NAMES) out << std::setw(12) << name;
+          out << "\n" << std::fixed << std::setprecision(1);
+          for (unsigned k = 0; k < 2; ++k)
           {
-          public:
-               B2(const TrigonometricCoeffs::Impl &impl) : m_impl(impl) { }
-               T operator()(T theta) const {
-                    return m_impl.b2(theta);
-               }
-
-          protected:
-               const TrigonometricCoeffs::Impl &m_impl;
-          };
-
-          const A0 a0;
-          const A1 a1;
-          const A2 a2;
-          const B0 b0;
-          const B1 b1;
-          const B2 b2;
-
-          T d(const A0 &, T theta) const {
-               return m_impl.da0(theta);
+               out << std::setw(12) << (k == 0 ? "incremental" : "fresh");
+               for (unsigned i = 0; i < 9; ++i) out << std::setw(12) << static_cast<double>(worst[k][i]);
+               out << "\n";
           }
+          stats.report(out);
+     }
 
-          T d(const A1 &, T theta) const {
-               return m_impl.da1(theta);
-          }
+     /**
+      * @brief Coefficient list visitor computing the longest coefficient name
+      */
+     struct MaxNameLength
+     {
+          size_t length = 0;
 
-          T d(const A2 &, T theta) const {
-               return m_impl.da2(theta);
+          template < class Coeff > void operator()(Coeff) {
+               length = std::max(length, std::strlen(Coeff::name()));
           }
+     };
+
+     /**
+      * @brief Registry visitor registering every technique in a validation
+      */
+     template < typename T, typename Ref > struct AddToValidation
+     {
+          rf::UlpValidation<T, Ref> &validation;
 
-          T d2(const A0 &, T theta) const {
-               return m_impl.d2a0(theta);
+          template < class TCs > void operator()(const TCs &tcs) {
+               validation.add_technique(TCs::name(), tcs);
           }
+     };
 
-          T d2(const A1 &, T theta) const {
-               return m_impl.d2a1(theta);
+     /**
+      * @brief Registry visitor creating one scheduler job per (technique, coefficient), writing
+      * into its sink column. The per-point loop of each job is fully static.
+      */
+     template < typename T, class PointFn > struct JobBuilder
+     {
+          rf::ResultSink<T> &sink;
+          const PointFn &point;
+          std::uint64_t n_points;
+          std::vector<rf::WorkStealingScheduler::Job> &jobs;
+          std::vector<std::string> &job_names;
+
+          template < class TCs, class Coeff > void operator()(const TCs &tcs, Coeff) {
+               T *res = sink.column(TCs::name(), Coeff::name());
+               const PointFn pt = point;
+               jobs.push_back({ [res, tcs, pt](std::size_t begin, std::size_t end) {
+                              for (std::size_t k = begin; k < end; ++k)
+                              {
+                                   res[k] = Coeff::eval(tcs, pt(k));
+                              }
+                         }, n_points });
+               job_names.push_back(std::string(TCs::name()) + "/" + Coeff::name());
           }
+     };
 
-          T d2(const A2 &, T theta) const {
-               return m_impl.d2a2(theta);
+     /**
+      * @brief Same as JobBuilder for columns stored in a 16-bit format: every chunk is evaluated
+      * in T, in blocks, and narrowed into its range of the column
+      */
+     template < typename T, class PointFn, class Narrow > struct NarrowJobBuilder
+     {
+          rf::ResultSink<Narrow> &sink;
+          const PointFn &point;
+          std::uint64_t n_points;
+          std::vector<rf::WorkStealingScheduler::Job> &jobs;
+          std::vector<std::string> &job_names;
+
+          template < class TCs, class Coeff > void operator()(const TCs &tcs, Coeff) {
+               Narrow *res = sink.column(TCs::name(), Coeff::name());
+               const PointFn pt = point;
+               jobs.push_back({ [res, tcs, pt](std::size_t begin, std::size_t end) {
+                              const std::size_t BLOCK = 256;
+                              T values[BLOCK];
+                              for (std::size_t i = begin; i < end; i += BLOCK)
+                              {
+                                   const std::size_t m = std::min(end - i, BLOCK);
+                                   for (std::size_t k = 0; k < m; ++k)
+                                   {
+                                        values[k] = Coeff::eval(tcs, pt(i + k));
+                                   }
+                                   Narrow::narrow(values, res + i, m);
+                              }
+                         }, n_points });
+               job_names.push_back(std::string(TCs::name()) + "/" + Coeff::name());
           }
      };
 
-     namespace detail
+     /**
+      * @brief Validates every technique of the registry against a reference computed in Ref
+      */
+     template < typename T, typename Ref, class Registry, class PointFn >
+     void validate(const Options &opts, Registry &registry, std::uint64_t n_points, const PointFn &point,
+                   std::ostream &out)
      {
-          template <typename T>
-          class TrigonometricCoeffsImpl<T, CalculationMode::Direct>
+          rf::UlpValidation<T, Ref> validation;
+          if (opts.storage == Options::Storage::Half) validation.template set_storage<rf::Half>();
+          else if (opts.storage == Options::Storage::BFloat16) validation.template set_storage<rf::BFloat16>();
+          AddToValidation<T, Ref> add{ validation };
+          registry.for_each_technique(add);
+          if (opts.stream)
           {
-          public:
-               static T a0(T theta) {
-                    return cos(theta);
-               }
-
-               static T a1(T theta) {
-                    return sin(theta) / theta;
-               }
-
-               static T a2(T theta) {
-                    return (T(1) - cos(theta)) / (theta * theta);
-               }
-
-               static T da0(T theta) {
-                    return -sin(theta);
-               }
-
-               static T da1(T theta) {
-                    return (theta * cos(theta) - sin(theta)) / (theta * theta);
-               }
-
-               static T da2(T theta) {
-                    return (theta * sin(theta) + T(2) * cos(theta) - T(2)) / pow(theta, 3);
-               }
-
-               static T d2a0(T theta) {
-                    return -cos(theta);
-               }
-
-               static T d2a1(T theta) {
-                    return -((pow(theta, 2) - 2) * sin(theta) + 2 * theta * cos(theta)) / pow(theta, 3);
-               }
-
-               static T d2a2(T theta) {
-                    return ((pow(theta, 2) - 6) * cos(theta) - 4 * theta * sin(theta) + 6) / pow(theta, 4);
-               }
-
-               static T b0(T theta) {
-                    return -sin(theta) / theta;
-               }
-
-               /**
-                * b_1 = \frac{1}{\theta} \diff{a_1(\theta)}{\theta}
-                */
-               static T b1(T theta) {
-                    return (theta * cos(theta) - sin(theta)) / pow(theta, 3);
-               }
-
-               /**
-                * b_2 = \frac{1}{\theta} \diff{a_2(\theta)}{\theta}
-                */
-               static T b2(T theta) {
-                    return (theta * sin(theta) + T(2) * cos(theta) - T(2)) / pow(theta, 4);
-               }
-          };
-
-          template <class T>
-          class TrigonometricCoeffsImpl<T, CalculationMode::NumericHyperDual>
+               validation.run_streaming(opts.n_threads, n_points, point, opts.chunk);
+          }
+          else
           {
-          public:
-               using RealType = T;
-
-               TrigonometricCoeffsImpl() :
-                    m_h1(1e-10),
-                    m_h2(1e-10) {
-               }
-
-               void set_steps(RealType h1, RealType h2) {
-                    m_h1 = h1;
-                    m_h2 = h2;
-               }
-
-               static RealType a0(RealType theta) {
-                    return cos(theta);
-               }
-
-               static RealType a1(RealType theta) {
-                    return sin(theta) / theta;
-               }
-
-               static RealType a2(RealType theta) {
-                    return (RealType(1) - cos(theta)) / pow(theta, 2);
-               }
-
-               RealType da0(RealType theta) const {
-                    return _a0(theta).eps1() / m_h1;
-               }
-
-               RealType da1(RealType theta) const {
-                    return _a1(theta).eps1() / m_h1;
-               }
-
-               RealType da2(RealType theta) const {
-                    return _a2(theta).eps1() / m_h1;
-               }
-
-               RealType d2a0(RealType theta) const {
-                    return _a0(theta).eps1eps2() / (m_h1 * m_h2);
-               }
-
-               RealType d2a1(RealType theta) const {
-                    return _a1(theta).eps1eps2() / (m_h1 * m_h2);
-               }
-
-               RealType d2a2(RealType theta) const {
-                    return _a2(theta).eps1eps2() / (m_h1 * m_h2);
-               }
+               rf::WorkStealingScheduler scheduler(opts.n_threads);
+               validation.run(scheduler, n_points, point);
+          }
+          validation.report(out);
+     }
 
-               RealType b0(RealType theta) const {
-                    return da0(theta) / theta;
-               }
+     /**
+      * @brief Adds a float column to the writer, converted to the Narrow storage format. The
+      * converted data is kept alive in buffers.
+      */
+     template < class Narrow >
+     void add_narrow_column(rf::ColumnarWriter &writer, const std::string &name, const std::vector<float> &values,
+                            std::vector<std::vector<Narrow>> &buffers)
+     {
+          buffers.emplace_back(values.size());
+          Narrow::narrow(values.data(), buffers.back().data(), values.size());
+          writer.add_column(name, buffers.back().data(), values.size());
+     }
+}
 
-               RealType b1(RealType theta) const {
-                    return da1(theta) / theta;
-               }
+int main(int argc, char *argv[])
+{
+     typedef float RealType;
 
-               RealType b2(RealType theta) const {
-                    return da2(theta) / theta;
-               }
+     typedef rf::TrigonometricCoeffs<RealType, rf::CalculationMode::Direct> TCsDir;
+     typedef rf::TrigonometricCoeffs<RealType, rf::CalculationMode::NumericHyperDual, SmallStepsPolicy> TCsHD;
+     typedef rf::TrigonometricCoeffs<RealType, rf::CalculationMode::SeriesExpansion> TCsSE;
+     typedef rf::TrigonometricCoeffs<RealType, rf::CalculationMode::Table> TCsTab;
+     typedef rf::TrigonometricCoeffs<RealType, rf::CalculationMode::MixedPrecision> TCsMix;
+     typedef rf::TrigonometricCoeffs<RealType, rf::CalculationMode::HalfAngle> TCsHalf;
+     typedef rf::TrigonometricCoeffs<RealType, rf::CalculationMode::AdaptiveSeries> TCsAdapt;
+     typedef rf::TrigonometricCoeffs<RealType, rf::CalculationMode::HyperDualSeries> TCsHDSeries;
+
+     Options opts;
+     try
+     {
+          opts = parse_options(argc, argv);
+     }
+     catch (const std::exception &e)
+     {
+          std::cerr << argv[0] << ": " << e.what() << "\n";
+          usage(argv[0]);
+          return EXIT_FAILURE;
+     }
 
-          protected:
-               RealType m_h1, m_h2;
+#ifdef RODRIGUES_INSTRUMENTATION
+     // Destroyed last, so the counters are printed on every return path once the workers are done
+     struct InstrumentationReport
+     {
+          ~InstrumentationReport() { rf::Instrumentation::report(std::cerr); }
+     } instrumentation_report;
+#endif
+
+     const RealType STEP = opts.step;
+     const long N_EVAL_PTS = opts.n_eval_pts;
+     const bool all_floats = opts.sweep == Options::Sweep::AllFloats;
+     const std::uint64_t n_points = all_floats ? (std::uint64_t(1) << 32) : std::uint64_t(N_EVAL_PTS);
+     // Points are generated from their index, so that no sweep needs to be materialized
+     auto point = [all_floats, STEP, N_EVAL_PTS](std::uint64_t k) -> RealType {
+          if (all_floats)
+          {
+               const std::uint32_t bits = static_cast<std::uint32_t>(k);
+               float v;
+               std::memcpy(&v, &bits, sizeof(v));
+               return v;
+          }
+          const long m = static_cast<long>(k) - N_EVAL_PTS / 2;
+          return m * STEP;
+     };
 
-               Hyperdual<RealType> _a0(RealType theta) const {
-                    Hyperdual<RealType> theta_hat(theta, m_h1, m_h2, 0);
-                    auto res = cos(theta_hat);
-                    return res;
-               }
+     typedef rf::CoefficientRegistry<rf::AllCoefficients, TCsDir, TCsHD, TCsSE, TCsTab, TCsMix, TCsHalf, TCsAdapt,
+                                 TCsHDSeries> Registry;
+     Registry registry;
+     if (opts.verbose)
+     {
+          TCsTab::Impl::table().report(std::cerr);
+     }
 
-               Hyperdual<RealType> _a1(RealType theta) const {
-                    Hyperdual<RealType> theta_hat{theta, m_h1, m_h2, 0};
-                    auto v = sin(theta_hat);
-                    return v / theta_hat;
-               }
+     if (opts.benchmark)
+     {
+          const std::uint64_t MAX_BENCHMARK_POINTS = std::uint64_t(1) << 20;
+          std::vector<RealType> theta(std::min(n_points, MAX_BENCHMARK_POINTS));
+          bool bounded = true;
+          for (std::size_t k = 0; k < theta.size(); ++k)
+          {
+               theta[k] = point(k);
+               bounded = bounded && std::fabs(theta[k]) <= RealType(3.14159265358979323846);
+          }
+          double checksum = 0;
+          std::cout << "Batch bundle evaluation, ns per point (" << theta.size() << " points)\n"
+                    << std::setw(18) << "mode" << std::setw(12) << rf::StdMath::name()
+                    << std::setw(12) << rf::VectorMath::name() << std::setw(12) << rf::PolynomialMath::name()
+                    << std::setw(12) << rf::BoundedPiMath::name() << "\n";
+          benchmark_backends<RealType, rf::CalculationMode::Direct>(theta, bounded, checksum, std::cout);
+          benchmark_backends<RealType, rf::CalculationMode::SeriesExpansion>(theta, bounded, checksum, std::cout);
+          benchmark_backends<RealType, rf::CalculationMode::AdaptiveSeries>(theta, bounded, checksum, std::cout);
+          benchmark_backends<RealType, rf::CalculationMode::MixedPrecision>(theta, bounded, checksum, std::cout);
+          benchmark_backends<RealType, rf::CalculationMode::HalfAngle>(theta, bounded, checksum, std::cout);
+          benchmark_backends<RealType, rf::CalculationMode::NumericHyperDual>(theta, bounded, checksum, std::cout);
+          benchmark_backends<RealType, rf::CalculationMode::HyperDualSeries>(theta, bounded, checksum, std::cout);
+          if (opts.verbose) std::cerr << "Checksum " << checksum << "\n";
+          return 0;
+     }
 
-               Hyperdual<RealType> _a2(RealType theta) const {
-                    Hyperdual<RealType> theta_hat(theta, m_h1, m_h2, 0);
-                    auto v = Hyperdual<RealType>(1, 0, 0, 0) - cos(theta_hat);
-                    return v / pow(theta_hat, RealType(2.0));
-               }
+     if (opts.memoize)
+     {
+          const std::uint64_t MAX_MEMOIZE_POINTS = std::uint64_t(1) << 20;
+          std::vector<RealType> theta(std::min(n_points, MAX_MEMOIZE_POINTS));
+          for (std::size_t k = 0; k < theta.size(); ++k) theta[k] = point(k);
+          rf::WorkStealingScheduler scheduler(opts.n_threads);
+          std::cout << "Repeated bundle evaluation, ns per point (" << theta.size() << " points, "
+                    << scheduler.workers() << " workers)\n"
+                    << std::setw(18) << "mode" << std::setw(12) << "plain" << std::setw(12) << "memoized"
+                    << "   cache counters\n";
+          memoize_run<TCsSE>(scheduler, theta, std::cout);
+          memoize_run<TCsHD>(scheduler, theta, std::cout);
+          return 0;
+     }
 
-          };
+     if (opts.incremental)
+     {
+          const std::uint64_t MAX_INCREMENTAL_POINTS = std::uint64_t(1) << 16;
+          std::vector<RealType> theta(std::min(n_points, MAX_INCREMENTAL_POINTS));
+          for (std::size_t k = 0; k < theta.size(); ++k) theta[k] = point(k);
+          incremental_run(theta, STEP, std::cout);
+          return 0;
+     }
 
-          template <typename T>
-          class TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion>
+     if (opts.validate)
+     {
+          std::ofstream output_file;
+          if (opts.output != "-") output_file.open(opts.output);
+          std::ostream &out = opts.output == "-" ? std::cout : output_file;
+          if (!out)
           {
-          public:
-               static T a0(T theta) {
-                    return s_direct.a0(theta);
-               }
-
-               static T a1(T theta) {
-                    if (theta > S_THRESHOLD) return s_direct.a1(theta);
-                    return ai(1, theta);
-               }
+               std::cerr << argv[0] << ": cannot open " << opts.output << "\n";
+               return EXIT_FAILURE;
+          }
+          if (opts.reference == Options::Reference::DoubleDouble)
+          {
+               validate<RealType, rf::DoubleDouble>(opts, registry, n_points, point, out);
+          }
+#ifdef RODRIGUES_HAVE_FLOAT128
+          else if (opts.reference == Options::Reference::Float128)
+          {
+               validate<RealType, __float128>(opts, registry, n_points, point, out);
+          }
+#endif
+          else
+          {
+               validate<RealType, long double>(opts, registry, n_points, point, out);
+          }
+          return 0;
+     }
 
-               static T a2(T theta) {
-                    if (theta > S_THRESHOLD) return s_direct.a2(theta);
-                    return ai(2, theta);
-               }
+     MaxNameLength name_len;
+     Registry::Coefficients::for_each(name_len);
+     const size_t max_name_len = name_len.length;
+
+     // The evaluation points are stored as an ungrouped "theta" column next to the results. They are
+     // always stored in float; with --store and a 16-bit storage the results go to their own sink.
+     std::unique_ptr<rf::ResultSink<RealType>> sink;
+     std::unique_ptr<rf::ResultSink<rf::Half>> half_sink;
+     std::unique_ptr<rf::ResultSink<rf::BFloat16>> bfloat16_sink;
+     rf::MemoryResultSink<RealType> *memory_sink = nullptr;
+     if (opts.store.empty())
+     {
+          memory_sink = new rf::MemoryResultSink<RealType>(n_points);
+          sink.reset(memory_sink);
+     }
+     else
+     {
+          sink.reset(new rf::MappedResultStore<RealType>(opts.store, n_points));
+     }
 
-               static T b0(T theta) {
-                    if (theta > S_THRESHOLD) return s_direct.b0(theta);
-                    return bi(0, theta);
-               }
+     // One job per (technique, coefficient). Their per-point costs differ a lot, so they are
+     // balanced by the work-stealing scheduler instead of being statically partitioned.
+     std::vector<rf::WorkStealingScheduler::Job> jobs;
+     std::vector<std::string> job_names;
+     try
+     {
+          RealType *thetas = sink->column("", "theta");
+          jobs.push_back({ [thetas, &point](std::size_t begin, std::size_t end) {
+                         for (std::size_t k = begin; k < end; ++k)
+                         {
+                              thetas[k] = point(k);
+                         }
+                    }, n_points });
+          job_names.push_back("theta");
+          if (memory_sink || opts.storage == Options::Storage::Float)
+          {
+               JobBuilder<RealType, decltype(point)> builder{ *sink, point, n_points, jobs, job_names };
+               registry.for_each(builder);
+          }
+          else if (opts.storage == Options::Storage::Half)
+          {
+               half_sink.reset(new rf::MappedResultStore<rf::Half>(opts.store, n_points));
+               NarrowJobBuilder<RealType, decltype(point), rf::Half> builder{ *half_sink, point, n_points, jobs, job_names };
+               registry.for_each(builder);
+          }
+          else
+          {
+               bfloat16_sink.reset(new rf::MappedResultStore<rf::BFloat16>(opts.store, n_points));
+               NarrowJobBuilder<RealType, decltype(point), rf::BFloat16> builder{ *bfloat16_sink, point, n_points,
+                                                                                  jobs, job_names };
+               registry.for_each(builder);
+          }
+     }
+     catch (const std::exception &e)
+     {
+          std::cerr << argv[0] << ": " << e.what() << "\n";
+          return EXIT_FAILURE;
+     }
 
-               static T b1(T theta) {
-                    if (theta > S_THRESHOLD) return s_direct.b1(theta);
-                    return bi(1, theta);
-               }
+     rf::WorkStealingScheduler scheduler(opts.n_threads);
+     const auto job_stats = scheduler.run(jobs);
+     if (opts.verbose)
+     {
+          std::cerr << "Scheduling statistics (" << scheduler.workers() << " workers)\n";
+          for (std::size_t j = 0; j < jobs.size(); ++j)
+          {
+               std::cerr << std::setw(16) << job_names[j]
+                         << ": " << job_stats[j].chunks << " chunks, "
+                         << job_stats[j].steals << " steals, "
+                         << job_stats[j].seconds << " s, "
+                         << job_stats[j].ns_per_item << " ns/point\n";
+          }
+     }
 
-               static T b2(T theta) {
-                    if (theta > S_THRESHOLD) return s_direct.b2(theta);
-                    return bi(2, theta);
-               }
+     if (!memory_sink)
+     {
+          // Everything is already in the mapped files
+          return 0;
+     }
+     const auto &results = memory_sink->columns();
+     const std::vector<RealType> &eval_pts = results.at("").at("theta");
 
-          protected:
-               static constexpr T S_ONE = 1.0;
-               static constexpr T S_THRESHOLD = 0.25;
-               static const int N_FACTORIALS = 15;
-               static const std::array<T,N_FACTORIALS> S_INV_FACTORIALS;
-               static class TrigonometricCoeffsImpl<T, CalculationMode::Direct> s_direct;
-
-#define theta_powers(theta)                                 \
-               T theta2, theta4, theta6, theta8, theta10;	\
-               theta2 = (theta) * (theta);                  \
-               theta4 = theta2 * theta2;                    \
-               theta6 = theta2 * theta4;                    \
-               theta8 = theta4 * theta4;                    \
-               theta10 = theta8 * theta2;                   \
-
-               static T ai(unsigned int i, T theta) {
-                    assert(i < 4);
-                    constexpr int N_STEPS = 6;
-                    theta_powers(theta);
-                    T s[N_STEPS] = { 1, -theta2, theta4, -theta6, theta8, -theta10 };
-                    for (unsigned int j = 0; j < N_STEPS; j++) {
-                         s[j] *= S_INV_FACTORIALS[2*j + i];
-                    }
-                    T res = 0.;
-                    for (unsigned int j = 0; j < N_STEPS; j++)
+     if (opts.format == Options::Format::Binary)
+     {
+          // The evaluation points are always stored in float
+          rf::ColumnarWriter writer;
+          std::vector<std::vector<rf::Half>> half_buffers;
+          std::vector<std::vector<rf::BFloat16>> bfloat16_buffers;
+          for (const auto &group : results)
+          {
+               for (const auto &technique : group.second)
+               {
+                    const std::string name = group.first.empty() ? technique.first : group.first + "/" + technique.first;
+                    if (group.first.empty() || opts.storage == Options::Storage::Float)
                     {
-                         res += s[j];
+                         writer.add_column(name, technique.second.data(), technique.second.size());
                     }
-                    return res;
-               }
-
-               static T bi(unsigned int i, T theta) {
-                    assert(i < 3);
-                    constexpr int N_STEPS = 6;
-                    theta_powers(theta);
-                    T s[N_STEPS] = { -2, 4*theta2, -6*theta4, 8*theta6, -10*theta8, 12*theta10 };
-                    for (unsigned int j = 0; j < N_STEPS; j++)
+                    else if (opts.storage == Options::Storage::Half)
                     {
-                         s[j] *= S_INV_FACTORIALS[2 + 2*j + i];
-                         // Max factorial idx: 2 + 2*5 + 3 = 15 -> fits
+                         add_narrow_column(writer, name, technique.second, half_buffers);
                     }
-                    T res = 0.;
-                    for (unsigned int j = 0; j < N_STEPS; j++)
+                    else
                     {
-                         res += s[j];
+                         add_narrow_column(writer, name, technique.second, bfloat16_buffers);
                     }
-                    return res;
                }
-          };
-
-          template <typename T> std::array<T,TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion>::N_FACTORIALS> const
-          TrigonometricCoeffsImpl<T, CalculationMode::SeriesExpansion>::S_INV_FACTORIALS =
-          { S_ONE / factorial(0), S_ONE / factorial(1), S_ONE / factorial(2), S_ONE / factorial(3), S_ONE / factorial(4),
-            S_ONE / factorial(5), S_ONE / factorial(6), S_ONE / factorial(7), S_ONE / factorial(8), S_ONE / factorial(9),
-            S_ONE / factorial(10), S_ONE / factorial(11), S_ONE / factorial(12), S_ONE / factorial(13), S_ONE / factorial(14) };
-
+          }
+          try
+          {
+               if (opts.output == "-") writer.write(STDOUT_FILENO);
+               else writer.write(opts.output);
+          }
+          catch (const std::exception &e)
+          {
+               std::cerr << argv[0] << ": " << e.what() << "\n";
+               return EXIT_FAILURE;
+          }
+          return 0;
      }
 
-}
-
-namespace rf = rodrigues_formula;
-
-int main(int argc, char *argv[])
-{
-     using namespace std::placeholders;
-
-     typedef float RealType;
-
-     typedef rf::TrigonometricCoeffs<RealType, rf::CalculationMode::Direct> TCsDir;
-     typedef rf::TrigonometricCoeffs<RealType, rf::CalculationMode::NumericHyperDual> TCsHD;
-     typedef rf::TrigonometricCoeffs<RealType, rf::CalculationMode::SeriesExpansion> TCsSE;
-
-     const RealType STEP = 1e-2;
-     const int N_EVAL_PTS = 101;
-     std::vector<RealType> eval_pts;
-     int m;
-     unsigned int i;
-     for (m = - N_EVAL_PTS / 2, i = 0;
-          i < N_EVAL_PTS;
-          m++, i++)
+     std::ofstream output_file;
+     if (opts.output != "-")
      {
-          eval_pts.push_back(m * STEP);
-     }
-
-     TCsDir tcs_dir;
-     TCsHD tcs_hd;
-     TCsSE tcs_se;
-     auto &tcs_hd_impl = tcs_hd.impl();
-     tcs_hd_impl.set_steps(1e-14, 1e-14);
-
-     // a_0(0.0) -> tcs_dir.a0(0.0);
-
-     std::map<std::string, std::function<RealType(RealType)>> derivs;
-     derivs["a0"] = tcs_dir.a0;
-     derivs["a1"] = tcs_dir.a1;
-     derivs["a2"] = tcs_dir.a2;
-     derivs["b0"] = tcs_dir.b0;
-     derivs["b1"] = tcs_dir.b1;
-     derivs["b2"] = tcs_dir.b2;
-
-     std::map<std::string, decltype(derivs)> all_derivs;
-     all_derivs["direct"] = std::move(derivs);
-
-     derivs.clear();
-     // derivs["d(a0)/dtheta"] = [&](double v) { return tcs_hd.d(tcs_hd.a0, v); };
-     // derivs["d(a1)/dtheta"] = [&](double v) { return tcs_hd.d(tcs_hd.a1, v); };
-     // derivs["d(a2)/dtheta"] = [&](double v) { return tcs_hd.d(tcs_hd.a2, v); };
-     // derivs["d^2(a0)/dtheta^2"] = [&](double v) { return tcs_hd.d2(tcs_hd.a0, v); };
-     // derivs["d^2(a1)/dtheta^2"] = [&](double v) { return tcs_hd.d2(tcs_hd.a1, v); };
-     // derivs["d^2(a2)/dtheta^2"] = [&](double v) { return tcs_hd.d2(tcs_hd.a2, v); };
-     derivs["a0"] = tcs_hd.a0;
-     derivs["a1"] = tcs_hd.a1;
-     derivs["a2"] = tcs_hd.a2;
-     derivs["b0"] = tcs_hd.b0;
-     derivs["b1"] = tcs_hd.b1;
-     derivs["b2"] = tcs_hd.b2;
-     all_derivs["hyperdual"] = std::move(derivs);
-
-     derivs.clear();
-     derivs["a0"] = tcs_se.a0;
-     derivs["a1"] = tcs_se.a1;
-     derivs["a2"] = tcs_se.a2;
-     derivs["b0"] = tcs_se.b0;
-     derivs["b1"] = tcs_se.b1;
-     derivs["b2"] = tcs_se.b2;
-
-     size_t max_name_len = 0;
-     for (auto &deriv : derivs)
-     {
-          max_name_len = std::max(max_name_len, deriv.first.length());
+          output_file.open(opts.output);
+          if (!output_file)
+          {
+               std::cerr << argv[0] << ": cannot open " << opts.output << "\n";
+               return EXIT_FAILURE;
+          }
      }
+     std::ostream &out = opts.output == "-" ? std::cout : output_file;
 
-     all_derivs["series"] = std::move(derivs);
-     derivs.clear();
-
-     std::map<std::string, std::map<std::string, std::vector<RealType>>> results;
-
-     for (auto &derivs : all_derivs)
+     // The text table shows the values as stored
+     for (const auto &group : results)
      {
-          for (auto &f : derivs.second)
+          if (group.first.empty()) continue;
+          for (const auto &technique : group.second)
           {
-               std::vector<RealType> res;
-               std::transform(std::begin(eval_pts), std::end(eval_pts), std::back_inserter(res), f.second);
-               results[derivs.first][f.first] = std::move(res);
+               RealType *values = sink->column(group.first, technique.first);
+               if (opts.storage == Options::Storage::Half) rf::round_to<rf::Half>(values, n_points);
+               else if (opts.storage == Options::Storage::BFloat16) rf::round_to<rf::BFloat16>(values, n_points);
           }
      }
 
      const int WIDTH = 14;
-     std::cout << std::scientific;
-     std::cout << std::setprecision(7);
+     out << std::scientific;
+     out << std::setprecision(7);
      const std::string SEPARATOR(" | ");
      for (unsigned int i = 0; i < max_name_len; ++i)
      {
-          std::cout << " ";
+          out << " ";
      }
      for (auto v : eval_pts)
      {
-          std::cout << SEPARATOR << std::setw(WIDTH) << v;
+          out << SEPARATOR << std::setw(WIDTH) << v;
      }
-     std::cout << "\n";
+     out << "\n";
 
      auto print_line = [&](const std::string &name = {}) {
          unsigned long i = 0;
          if (!name.empty())
          {
-              std::cout << "- " << name << " ";
+              out << "- " << name << " ";
               i = name.length() + 3;
          }
          for (; i < max_name_len + (WIDTH + SEPARATOR.length()) * eval_pts.size(); ++i)
          {
-              std::cout << "-";
+              out << "-";
          }
-         std::cout << "\n";
+         out << "\n";
      };
 
      for (const auto &group : results)
      {
+          if (group.first.empty()) continue;
           print_line(group.first);
           for (const auto &technique : group.second)
           {
-               std::cout << std::setw(max_name_len) << technique.first;
+               out << std::setw(max_name_len) << technique.first;
                for (const auto &v : technique.second)
                {
-                    std::cout << SEPARATOR << std::setw(WIDTH) << v;
+                    out << SEPARATOR << std::setw(WIDTH) << v;
                }
-               std::cout << "\n";
+               out << "\n";
           }
      }
      print_line();